@@ -17,30 +17,83 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stdatomic.h>
 #include "esp_log.h"
 #include "esp_rom_sys.h"
 #include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
 #include "driver/gpio.h"
+#include "soc/gpio_struct.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
 #include "andon_display.h"
+#include "display_waveform.h"
 #include "pin_config.h"
 #include "system_state.h"
-#include "rtc_ds1307.h"
+#include "time_service.h"
+#include "time_accounting.h"
 #include "led_strip.h"
 
+#if ANDON_DISPLAY_BACKEND == DISPLAY_BACKEND_I2S_DMA
+#include "esp_rom_gpio.h"
+#include "esp_private/periph_ctrl.h"
+#include "rom/lldesc.h"
+#include "soc/i2s_struct.h"
+#include "soc/gpio_sig_map.h"
+#endif
+
 static const char *TAG = "andon_display";
 
-// Double buffering for scan_data to prevent race conditions
+// İki backend aynı tarama periyodunda: I2S dalga formu ve orijinal task
+_Static_assert(DISPLAY_WAVE_SCAN_US == DISPLAY_SCAN_PERIOD_US, "I2S tarama süresi DISPLAY_SCAN_PERIOD_US ile aynı olmalı");
+
+// Tarama programı adımı: bir latch için hazır GPIO register kelimeleri
+// (render sırasında hesaplanır, tarayıcı sadece store yapar)
+typedef struct {
+    uint32_t data_set;  // GPIO.out_w1ts: BCD 1 bitleri
+    uint32_t data_clr;  // GPIO.out_w1tc: BCD 0 bitleri
+    uint32_t strobe;    // LD pin maskesi
+    uint32_t value;     // BCD değeri (latch'te zaten varsa adım atlanır)
+} scan_step_t;
+
+// Bir frame: BCD değerleri (render modeli / DMA derleyicisi) + derlenmiş program
+typedef struct {
+    _Atomic uint32_t seq;       // Tek = yazım sürüyor, çift = tamamlandı
+    uint8_t digit[6][8];
+    scan_step_t step[6][8];
+} scan_frame_t;
+
+// ============ Triple Buffer (tek üretici / tek tüketici, kilitsiz) ============
 // Tarama 0 = en sağdaki hane (birler), Tarama 5 = en soldaki hane
-static uint8_t scan_data_buffers[2][6][8] = {0};
-static volatile int active_buffer = 0;  // Display reads from this
-static volatile int write_buffer = 1;   // Update writes to this
+//
+// back   : sadece render (üretici) yazar
+// front  : sadece tarayıcı (tüketici) okur
+// latest : en son yayınlanan frame; iki taraf atomic_exchange ile takas eder
+// Render hiçbir zaman tarayıcının okuduğu frame'e dokunamaz; tarayıcı her frame
+// başında (tarama 0) en yeni frame'e geçer.
+#define FRAME_INDEX_MASK    0x3U
+#define FRAME_FRESH         0x4U    // latest okunmamış yeni frame içeriyor
+
+static DRAM_ATTR scan_frame_t scan_frames[3];
+static DRAM_ATTR _Atomic uint32_t s_latest = 1;
+static uint32_t s_back = 2;
+
+// Render tarafı tek üretici: buffer'lara sadece display_render task'ı dokunur,
+// diğer task'lar andon_display_invalidate ile dirty bit bırakır
+static TaskHandle_t s_render_task = NULL;
+static _Atomic uint32_t s_stat_render_requests = 0;
+static volatile uint32_t s_stat_published = 0;
+static volatile uint32_t s_stat_torn_frames = 0;
 
-// Macro for easier access
-#define SCAN_DATA_READ  scan_data_buffers[active_buffer]
-#define SCAN_DATA_WRITE scan_data_buffers[write_buffer]
+// Macro for easier access (render sırasında back buffer sabittir)
+#define SCAN_DATA_WRITE scan_frames[s_back].digit
+#define SCAN_PROG_WRITE scan_frames[s_back].step
+
+#if ANDON_DISPLAY_BACKEND == DISPLAY_BACKEND_I2S_DMA
+static void display_wave_publish(const uint8_t scan_data[6][8], bool screen_on);
+#endif
 
 // Özel karakterler (CD4543 BCD -> Segment mapping varsayımları)
 // L=12, E=14, d=13, P=11, r=10 (standard symbol mapping)
@@ -52,23 +105,150 @@ static volatile int write_buffer = 1;   // Update writes to this
 #define CHAR_S 5   // '5' looks like 'S'
 #define CHAR_U 11  // Some decoders show U at 11
 
+// ============ Register-level GPIO Çıkış Katmanı ============
+// Tüm display pinleri GPIO0-31 aralığında: her grup tek bir W1TS + W1TC
+// yazımıyla sürülür (gpio_set_level flash'ta ve her çağrıda argüman kontrolü yapar)
+#define DISPLAY_PIN_BIT(pin)  (1UL << (pin))
+
+_Static_assert(HC138_A0_PIN < 32 && HC138_A1_PIN < 32 && HC138_A2_PIN < 32,
+               "HC138 pinleri GPIO.out_w1ts (0-31) aralığında olmalı");
+_Static_assert(CD4543_D0_PIN < 32 && CD4543_D1_PIN < 32 &&
+               CD4543_D2_PIN < 32 && CD4543_D3_PIN < 32,
+               "CD4543 data pinleri GPIO.out_w1ts (0-31) aralığında olmalı");
+_Static_assert(CD4543_LD1_PIN < 32 && CD4543_LD2_PIN < 32 && CD4543_LD3_PIN < 32 &&
+               CD4543_LD4_PIN < 32 && CD4543_LD5_PIN < 32 && CD4543_LD6_PIN < 32 &&
+               CD4543_LD7_PIN < 32 && CD4543_LD8_PIN < 32,
+               "CD4543 LD pinleri GPIO.out_w1ts (0-31) aralığında olmalı");
+
+// Init'te pin_config.h'tan hesaplanan set/clear maskeleri (DRAM: flash pause sırasında da okunabilir)
+static DRAM_ATTR uint32_t s_bcd_set_mask[16];
+static DRAM_ATTR uint32_t s_bcd_clr_mask[16];
+static DRAM_ATTR uint32_t s_hane_set_mask[8];
+static DRAM_ATTR uint32_t s_hane_clr_mask[8];
+static DRAM_ATTR uint32_t s_ld_mask[8];
+
+static void display_out_build_masks(void) {
+    const uint32_t bcd_bits[4] = {
+        DISPLAY_PIN_BIT(CD4543_D0_PIN), DISPLAY_PIN_BIT(CD4543_D1_PIN),
+        DISPLAY_PIN_BIT(CD4543_D2_PIN), DISPLAY_PIN_BIT(CD4543_D3_PIN),
+    };
+    const uint32_t hane_bits[3] = {
+        DISPLAY_PIN_BIT(HC138_A0_PIN), DISPLAY_PIN_BIT(HC138_A1_PIN), DISPLAY_PIN_BIT(HC138_A2_PIN),
+    };
+    const gpio_num_t ld_pins[8] = {
+        CD4543_LD1_PIN, CD4543_LD2_PIN, CD4543_LD3_PIN, CD4543_LD4_PIN,
+        CD4543_LD5_PIN, CD4543_LD6_PIN, CD4543_LD7_PIN, CD4543_LD8_PIN,
+    };
+
+    for (int value = 0; value < 16; value++) {
+        s_bcd_set_mask[value] = 0;
+        s_bcd_clr_mask[value] = 0;
+        for (int bit = 0; bit < 4; bit++) {
+            if ((value >> bit) & 1) {
+                s_bcd_set_mask[value] |= bcd_bits[bit];
+            } else {
+                s_bcd_clr_mask[value] |= bcd_bits[bit];
+            }
+        }
+    }
+
+    for (int hane = 0; hane < 8; hane++) {
+        s_hane_set_mask[hane] = 0;
+        s_hane_clr_mask[hane] = 0;
+        for (int bit = 0; bit < 3; bit++) {
+            if ((hane >> bit) & 1) {
+                s_hane_set_mask[hane] |= hane_bits[bit];
+            } else {
+                s_hane_clr_mask[hane] |= hane_bits[bit];
+            }
+        }
+    }
+
+    for (int latch = 0; latch < 8; latch++) {
+        s_ld_mask[latch] = DISPLAY_PIN_BIT(ld_pins[latch]);
+    }
+}
+
+static inline void IRAM_ATTR display_out_bcd(int bcd_value) {
+    GPIO.out_w1tc = s_bcd_clr_mask[bcd_value & 0x0F];
+    GPIO.out_w1ts = s_bcd_set_mask[bcd_value & 0x0F];
+}
+
+static inline void IRAM_ATTR display_out_hane(int hane) {
+    GPIO.out_w1tc = s_hane_clr_mask[hane & 0x07];
+    GPIO.out_w1ts = s_hane_set_mask[hane & 0x07];
+}
+
 // ============ HC138 Selection (0-5 valid, 6-7 = all off) ============
 static void IRAM_ATTR andon_display_select_hane(int hane) {
-    gpio_set_level(HC138_A0_PIN, (hane >> 0) & 1);
-    gpio_set_level(HC138_A1_PIN, (hane >> 1) & 1);
-    gpio_set_level(HC138_A2_PIN, (hane >> 2) & 1);
+    display_out_hane(hane);
     esp_rom_delay_us(10);
 }
 
-// ============ CD4543 BCD Output ============
-static void IRAM_ATTR andon_display_send_bcd(int bcd_value) {
+#if ANDON_DISPLAY_BACKEND != DISPLAY_BACKEND_I2S_DMA
+// ============ Tarama Programı Derleme (render zamanı) ============
+// BCD nibble -> register kelimeleri dönüşümü sadece değişen alanın sütunu için
+// burada yapılır, saniyede yüzlerce kez çalışan tarama döngüsünde değil.
+static void display_compile_column(const uint8_t digit[6][8], scan_step_t step[6][8], int latch) {
+    for (int scan = 0; scan < 6; scan++) {
+        uint8_t value = digit[scan][latch] & 0x0F;
+        step[scan][latch].data_set = s_bcd_set_mask[value];
+        step[scan][latch].data_clr = s_bcd_clr_mask[value];
+        step[scan][latch].strobe = s_ld_mask[latch];
+        step[scan][latch].value = value;
+    }
+}
+#endif
+
+#if ANDON_DISPLAY_BENCHMARK
+// ============ Benchmark: gpio_set_level vs register yazımı ============
+// Sadece çıkış maliyeti ölçülür (esp_rom_delay_us bekleme süreleri hariç).
+// Tarama task'ı başlamadan çağrılır; HC138 = 7 tutulduğu için ekranda görünmez.
+#define DISPLAY_BENCH_ITERATIONS  1000
+
+static void display_out_legacy_bcd(int bcd_value) {
     gpio_set_level(CD4543_D0_PIN, (bcd_value >> 0) & 1);
     gpio_set_level(CD4543_D1_PIN, (bcd_value >> 1) & 1);
     gpio_set_level(CD4543_D2_PIN, (bcd_value >> 2) & 1);
     gpio_set_level(CD4543_D3_PIN, (bcd_value >> 3) & 1);
-    esp_rom_delay_us(10);
 }
 
+static void display_out_legacy_hane(int hane) {
+    gpio_set_level(HC138_A0_PIN, (hane >> 0) & 1);
+    gpio_set_level(HC138_A1_PIN, (hane >> 1) & 1);
+    gpio_set_level(HC138_A2_PIN, (hane >> 2) & 1);
+}
+
+static void display_out_benchmark(void) {
+    const gpio_num_t ld_pin = CD4543_LD1_PIN;
+
+    // Legacy: 4 (BCD) + 3 (HC138) + 2 (latch) = 9 gpio_set_level çağrısı
+    esp_cpu_cycle_count_t start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < DISPLAY_BENCH_ITERATIONS; i++) {
+        display_out_legacy_bcd(i & 0x0F);
+        gpio_set_level(ld_pin, 1);
+        gpio_set_level(ld_pin, 0);
+        display_out_legacy_hane(7);
+    }
+    uint32_t legacy_cycles = esp_cpu_get_cycle_count() - start;
+
+    // Register: 2 (BCD) + 2 (HC138) + 2 (latch) = 6 store
+    start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < DISPLAY_BENCH_ITERATIONS; i++) {
+        display_out_bcd(i & 0x0F);
+        GPIO.out_w1ts = s_ld_mask[0];
+        GPIO.out_w1tc = s_ld_mask[0];
+        display_out_hane(7);
+    }
+    uint32_t reg_cycles = esp_cpu_get_cycle_count() - start;
+
+    ESP_LOGI(TAG, "GPIO benchmark (%d iter, BCD+latch+HC138): gpio_set_level=%lu cyc/iter, register=%lu cyc/iter",
+             DISPLAY_BENCH_ITERATIONS,
+             (unsigned long)(legacy_cycles / DISPLAY_BENCH_ITERATIONS),
+             (unsigned long)(reg_cycles / DISPLAY_BENCH_ITERATIONS));
+}
+#endif // ANDON_DISPLAY_BENCHMARK
+
 // ============ Helper: Time to digits (HH:MM:SS -> 6 digits) ============
 static void time_to_6digits(uint32_t total_sec, uint8_t out[6]) {
     uint32_t sec = total_sec % 60;
@@ -129,174 +309,443 @@ static void verim_to_2digits(uint32_t verim, uint8_t out[2]) {
     }
 }
 
-// ============ Update scan data from system values ============
-void andon_display_update(void) {
-    uint8_t saat[6];        // LD1: RTC saat
-    uint8_t durus[4];       // LD2: Duruş süresi (MM:SS)
-    uint8_t calisma[6];     // LD3: Çalışma zamanı
-    uint8_t atil[6];        // LD4: Atıl zaman
-    uint8_t planli[6];      // LD5: Planlı duruş
-    uint8_t hedef[4];       // LD6: Hedef adet
-    uint8_t gerceklesen[4]; // LD7: Gerçekleşen adet
-    uint8_t verim[2];       // LD8: Verim %
-    
-    // LD1: SAAT - RTC'den al
-    struct tm tm_now;
-    if (sys_data.clock_step == 0) {
-        if (rtc_ds1307_read_tm(&tm_now) == ESP_OK) {
-            saat[0] = tm_now.tm_sec % 10;
-            saat[1] = tm_now.tm_sec / 10;
-            saat[2] = tm_now.tm_min % 10;
-            saat[3] = tm_now.tm_min / 10;
-            saat[4] = tm_now.tm_hour % 10;
-            saat[5] = tm_now.tm_hour / 10;
-        } else {
-            time_t now = time(NULL);
-            struct tm *tm_local = localtime(&now);
-            saat[0] = tm_local->tm_sec % 10;
-            saat[1] = tm_local->tm_sec / 10;
-            saat[2] = tm_local->tm_min % 10;
-            saat[3] = tm_local->tm_min / 10;
-            saat[4] = tm_local->tm_hour % 10;
-            saat[5] = tm_local->tm_hour / 10;
+// ============ Display Modeli (alan bazlı artımlı render) ============
+// Her alan (LD1..LD8, alan indeksi = latch indeksi) son render edildiği kaynak
+// değeri (kind + key) tutar. Render'da sadece key'i değişen alan formatlanır ve
+// model sütununa yerleştirilir; model tam frame olarak back buffer'a kopyalanır.
+#define FIELD_KIND_NONE         0   // Henüz render edilmedi
+#define FIELD_KIND_NORMAL       1
+#define FIELD_KIND_CLOCK_SET    2   // Saat ayarı (HH:MM:00, yan-sön)
+#define FIELD_KIND_MENU         3   // Menü ekranı (key = menu_step | değer << 32)
+
+static uint8_t s_model_digit[6][8];
+#if ANDON_DISPLAY_BACKEND != DISPLAY_BACKEND_I2S_DMA
+static scan_step_t s_model_step[6][8];
+#endif
+static uint8_t s_field_kind[DISPLAY_FIELD_COUNT];
+static uint64_t s_field_key[DISPLAY_FIELD_COUNT];
+static bool s_model_screen_on = false;
+static volatile uint32_t s_stat_field_renders[DISPLAY_FIELD_COUNT];
+static volatile uint32_t s_stat_field_rendered_at[DISPLAY_FIELD_COUNT];
+
+// Alanın şu anki kaynak değeri (I2C yok: saat time service önbelleğinden gelir).
+// Tüm alanlar aynı snapshot'tan okunur: hedef/gerçekleşen/verim tutarlıdır.
+// Saat ve süre sayaçları son tikin saniye kenarında değerlendirilir: render ne
+// zaman çalışırsa çalışsın haneler kenarla aynı fazda ilerler.
+static void display_field_source(const system_snapshot_t *snap, int64_t edge_us, int field, uint8_t *kind, uint64_t *key) {
+    if (snap->data.menu_step > 0) {
+        *kind = FIELD_KIND_MENU;
+        *key = snap->data.menu_step;
+        if (field == DISPLAY_FIELD_ATIL) {
+            // Menü değeri LD4 (Atıl Zaman) hanesinde görünür
+            uint32_t value = 0;
+            if (snap->data.menu_step == 1) {
+                value = snap->data.led_brightness_idx;
+            } else if (snap->data.menu_step == 2) {
+                value = led_strip_get_cycle_target();
+            } else if (snap->data.menu_step == 3) {
+                value = snap->data.ir_learn_step;
+            }
+            *key |= (uint64_t)value << 32;
         }
-    } else {
-        // SAAT AYARI MODU - HH:MM:00
-        saat[0] = 0; // Saniye her zaman 0
-        saat[1] = 0;
-        
-        // Dakika Haneleri
-        if (sys_data.clock_step == 2 && !sys_data.clock_blink_on) {
-            saat[2] = DISPLAY_BLANK;
-            saat[3] = DISPLAY_BLANK;
-        } else {
-            saat[2] = sys_data.clock_minutes % 10;
-            saat[3] = sys_data.clock_minutes / 10;
+        return;
+    }
+
+    *kind = FIELD_KIND_NORMAL;
+    switch (field) {
+        case DISPLAY_FIELD_SAAT:
+            if (snap->data.clock_step > 0) {
+                *kind = FIELD_KIND_CLOCK_SET;
+                *key = (uint64_t)snap->data.clock_step | ((uint64_t)snap->data.clock_blink_on << 8) |
+                       ((uint64_t)snap->data.clock_minutes << 16) | ((uint64_t)snap->data.clock_hours << 24);
+            } else {
+                *key = time_service_epoch_at_edge(edge_us) % 86400UL;
+            }
+            break;
+        case DISPLAY_FIELD_DURUS:       *key = time_accounting_get_at(ACCT_DURUS, edge_us); break;
+        case DISPLAY_FIELD_CALISMA:     *key = time_accounting_get_at(ACCT_WORK, edge_us); break;
+        case DISPLAY_FIELD_ATIL:        *key = time_accounting_get_at(ACCT_IDLE, edge_us); break;
+        case DISPLAY_FIELD_PLANLI:      *key = time_accounting_get_at(ACCT_PLANNED, edge_us); break;
+        case DISPLAY_FIELD_HEDEF:       *key = snap->data.target_count; break;
+        case DISPLAY_FIELD_GERCEKLESEN: *key = snap->produced_count; break;
+        case DISPLAY_FIELD_VERIM:
+        default:
+            *key = ((uint64_t)snap->data.target_count << 32) | snap->produced_count;
+            break;
+    }
+}
+
+// Alanı tarama sırasına göre 6 haneye formatla (out[0] = tarama 0 = en sağ).
+// 4 ve 2 haneli alanlar sola yaslıdır: sağdaki boş taramalar blank.
+static void display_field_format(int field, uint8_t kind, uint64_t key, uint8_t out[6]) {
+    memset(out, DISPLAY_BLANK, 6);
+
+    if (kind == FIELD_KIND_MENU) {
+        if (field != DISPLAY_FIELD_ATIL) {
+            return;
         }
-        
-        // Saat Haneleri
-        if (sys_data.clock_step == 1 && !sys_data.clock_blink_on) {
-            saat[4] = DISPLAY_BLANK;
-            saat[5] = DISPLAY_BLANK;
-        } else {
-            saat[4] = sys_data.clock_hours % 10;
-            saat[5] = sys_data.clock_hours / 10;
+        uint32_t menu_step = (uint32_t)(key & 0xFF);
+        uint32_t value = (uint32_t)(key >> 32);
+        if (menu_step == 1) {
+            // Parlaklık Ayarı: tek hane
+            out[0] = value;
+        } else if (menu_step == 2) {
+            // Süre Ayarı: 6 hane
+            for (int i = 0; i < 6; i++) {
+                out[i] = value % 10;
+                value /= 10;
+            }
+        } else if (menu_step == 3) {
+            // IR Öğrenme: beklenen tuş sırası, 2 hane
+            out[0] = value % 10;
+            out[1] = (value / 10) % 10;
         }
+        return;
     }
-    
-    // LD2: DURUŞ SÜRESİ (MM:SS)
-    time_to_4digits(sys_data.durus_time, durus);
-    
-    // LD3: ÇALIŞMA ZAMANI
-    time_to_6digits(sys_data.work_time, calisma);
-    
-    // LD4: ATIL ZAMAN
-    time_to_6digits(sys_data.idle_time, atil);
-    
-    // LD5: PLANLI DURUŞ
-    time_to_6digits(sys_data.planned_time, planli);
-    
-    // LD6: HEDEF ADET
-    count_to_4digits(sys_data.target_count, hedef);
-    
-    // LD7: GERÇEKLEŞEN ADET
-    count_to_4digits(sys_data.produced_count, gerceklesen);
-    
-    // LD8: VERİM (%)
-    uint32_t verim_val = 0;
-    if (sys_data.target_count > 0) {
-        verim_val = (sys_data.produced_count * 100 + sys_data.target_count / 2) / sys_data.target_count;
-        if (verim_val > 99) verim_val = 99;  // Max 99%
-    }
-    verim_to_2digits(verim_val, verim);
-    
-    // ========== MENÜ AYAR EKRANI MODU ==========
-    if (sys_data.menu_step > 0) {
-        // Tüm haneleri temizle varsayılan olarak
-        memset(saat, DISPLAY_BLANK, sizeof(saat));
-        memset(durus, DISPLAY_BLANK, sizeof(durus));
-        memset(calisma, DISPLAY_BLANK, sizeof(calisma));
-        memset(atil, DISPLAY_BLANK, sizeof(atil));
-        memset(planli, DISPLAY_BLANK, sizeof(planli));
-        memset(hedef, DISPLAY_BLANK, sizeof(hedef));
-        memset(gerceklesen, DISPLAY_BLANK, sizeof(gerceklesen));
-        memset(verim, DISPLAY_BLANK, sizeof(verim));
-
-        if (sys_data.menu_step == 1) {
-            // Parlaklık Ayarı: Değer LD4 (Atıl Zaman) hanesinde görünür
-            atil[0] = sys_data.led_brightness_idx;
-        } else if (sys_data.menu_step == 2) {
-            // Süre Ayarı: Değer LD4 (Atıl Zaman) hanesinde görünür
-            uint32_t target = led_strip_get_cycle_target();
-            atil[0] = target % 10;
-            atil[1] = (target / 10) % 10;
-            atil[2] = (target / 100) % 10;
-            atil[3] = (target / 1000) % 10;
-            atil[4] = (target / 10000) % 10;
-            atil[5] = (target / 100000) % 10;
+
+    if (kind == FIELD_KIND_CLOCK_SET) {
+        // SAAT AYARI MODU - HH:MM:00
+        uint8_t step = key & 0xFF;
+        bool blink_on = (key >> 8) & 1;
+        uint8_t minutes = (key >> 16) & 0xFF;
+        uint8_t hours = (key >> 24) & 0xFF;
+
+        out[0] = 0;  // Saniye her zaman 0
+        out[1] = 0;
+        if (!(step == 2 && !blink_on)) {
+            out[2] = minutes % 10;
+            out[3] = minutes / 10;
         }
+        if (!(step == 1 && !blink_on)) {
+            out[4] = hours % 10;
+            out[5] = hours / 10;
+        }
+        return;
     }
-    
-    // Write to WRITE buffer (display reads from ACTIVE buffer)
-    // Önce write buffer'ı temizle (Ghosting veya eski verileri engellemek için)
-    memset(SCAN_DATA_WRITE, DISPLAY_BLANK, sizeof(SCAN_DATA_WRITE));
-    
-    // Her tarama (0-5) bir hane pozisyonu
-    // Tarama 0 = en sağ (birler), Tarama 5 = en sol (yüzler/onlar)
-    for (int scan = 0; scan < 6; scan++) {
-        // LD1: SAAT (6 hane)
-        SCAN_DATA_WRITE[scan][0] = saat[scan];
-        
-        // LD2: DURUŞ (4 hane, SOLA YASLI: scan 0-1 için blank, scan 2-5 için veri)
-        if (scan >= 2) {
-            SCAN_DATA_WRITE[scan][1] = durus[scan - 2];
-        } else {
-            SCAN_DATA_WRITE[scan][1] = DISPLAY_BLANK;
+
+    switch (field) {
+        case DISPLAY_FIELD_SAAT:        // LD1: RTC saat
+        case DISPLAY_FIELD_CALISMA:     // LD3: Çalışma zamanı
+        case DISPLAY_FIELD_ATIL:        // LD4: Atıl zaman
+        case DISPLAY_FIELD_PLANLI:      // LD5: Planlı duruş
+            time_to_6digits((uint32_t)key, out);
+            break;
+        case DISPLAY_FIELD_DURUS:       // LD2: Duruş süresi (MM:SS)
+            time_to_4digits((uint32_t)key, &out[2]);
+            break;
+        case DISPLAY_FIELD_HEDEF:       // LD6: Hedef adet
+        case DISPLAY_FIELD_GERCEKLESEN: // LD7: Gerçekleşen adet
+            count_to_4digits((uint32_t)key, &out[2]);
+            break;
+        case DISPLAY_FIELD_VERIM:       // LD8: Verim %
+        default: {
+            uint32_t target = (uint32_t)(key >> 32);
+            uint32_t produced = (uint32_t)key;
+            uint32_t verim_val = 0;
+            if (target > 0) {
+                verim_val = (produced * 100 + target / 2) / target;
+                if (verim_val > 99) verim_val = 99;  // Max 99%
+            }
+            verim_to_2digits(verim_val, &out[4]);
+            break;
         }
-        
-        // LD3: ÇALIŞMA (6 hane)
-        SCAN_DATA_WRITE[scan][2] = calisma[scan];
-        
-        // LD4: ATIL (6 hane)
-        SCAN_DATA_WRITE[scan][3] = atil[scan];
-        
-        // LD5: PLANLI (6 hane)
-        SCAN_DATA_WRITE[scan][4] = planli[scan];
-        
-        // LD6: HEDEF (4 hane, SOLA YASLI)
-        if (scan >= 2) {
-            SCAN_DATA_WRITE[scan][5] = hedef[scan - 2];
-        } else {
-            SCAN_DATA_WRITE[scan][5] = DISPLAY_BLANK;
+    }
+}
+
+// ============ Render: değişen alanları modele işle, frame'i yayınla ============
+static void display_render_frame(void) {
+    bool changed = false;
+    system_snapshot_t snap;
+    sys_data_snapshot(&snap);
+
+    // İlk tikten önce kenar yok: içinde bulunulan saniyenin başını kullan
+    int64_t edge_us = snap.data.tick_edge_us;
+    if (edge_us == 0) {
+        edge_us = time_service_second_start_us(esp_timer_get_time());
+    }
+
+    for (int field = 0; field < DISPLAY_FIELD_COUNT; field++) {
+        uint8_t kind;
+        uint64_t key;
+        display_field_source(&snap, edge_us, field, &kind, &key);
+        if (kind == s_field_kind[field] && key == s_field_key[field]) {
+            continue;
         }
-        
-        // LD7: GERÇEKLEŞEN (4 hane, SOLA YASLI)
-        if (scan >= 2) {
-            SCAN_DATA_WRITE[scan][6] = gerceklesen[scan - 2];
-        } else {
-            SCAN_DATA_WRITE[scan][6] = DISPLAY_BLANK;
+
+        uint8_t digits[6];
+        display_field_format(field, kind, key, digits);
+        for (int scan = 0; scan < 6; scan++) {
+            s_model_digit[scan][field] = digits[scan];
         }
-        
-        // LD8: VERİM (2 hane, SOLA YASLI)
-        if (scan >= 4) {
-            SCAN_DATA_WRITE[scan][7] = verim[scan - 4];
-        } else {
-            SCAN_DATA_WRITE[scan][7] = DISPLAY_BLANK;
+#if ANDON_DISPLAY_BACKEND != DISPLAY_BACKEND_I2S_DMA
+        // BCD -> GPIO kelimeleri (tarayıcı sadece store yapar)
+        display_compile_column(s_model_digit, s_model_step, field);
+#endif
+        s_field_kind[field] = kind;
+        s_field_key[field] = key;
+        s_stat_field_renders[field]++;
+        s_stat_field_rendered_at[field] = s_stat_published + 1;
+        changed = true;
+    }
+
+    if (!changed && snap.data.screen_on == s_model_screen_on) {
+        return;  // Ekranda değişen bir şey yok, yeni frame yayınlanmaz
+    }
+    s_model_screen_on = snap.data.screen_on;
+
+    // Back buffer'a yaz (tarayıcı front buffer'ı okur)
+    // Yazım başladı: seq tek (tarayıcı bu frame'i tutuyorsa yırtık sayar)
+    scan_frame_t *frame = &scan_frames[s_back];
+    uint32_t seq = atomic_load_explicit(&frame->seq, memory_order_relaxed);
+    atomic_store_explicit(&frame->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    memcpy(SCAN_DATA_WRITE, s_model_digit, sizeof(s_model_digit));
+#if ANDON_DISPLAY_BACKEND != DISPLAY_BACKEND_I2S_DMA
+    memcpy(SCAN_PROG_WRITE, s_model_step, sizeof(s_model_step));
+#endif
+
+#if ANDON_DISPLAY_BACKEND == DISPLAY_BACKEND_I2S_DMA
+    display_wave_publish(SCAN_DATA_WRITE, snap.data.screen_on);
+#endif
+
+    // Yazım bitti (seq çift), frame'i yayınla; eski latest yeni back olur
+    atomic_store_explicit(&frame->seq, seq + 2, memory_order_release);
+    uint32_t prev = atomic_exchange_explicit(&s_latest, s_back | FRAME_FRESH, memory_order_acq_rel);
+    s_back = prev & FRAME_INDEX_MASK;
+    s_stat_published++;
+}
+
+// ============ Render Task (buffer'ların tek sahibi) ============
+// Dirty bitleri task notification değerinde birikir (eSetBits). Task uyanınca
+// biriken bitleri alıp tek render yapar, sonra DISPLAY_RENDER_PERIOD_MS bekler:
+// bu sürede gelen istekler bir sonraki tek render'da birleşir.
+static void display_render_task(void *pvParameters) {
+    uint32_t dirty;
+
+    while (1) {
+        xTaskNotifyWait(0, UINT32_MAX, &dirty, portMAX_DELAY);
+        if (dirty & DISPLAY_DIRTY_ALL) {
+            display_render_frame();
         }
+        vTaskDelay(pdMS_TO_TICKS(DISPLAY_RENDER_PERIOD_MS));
     }
-    
-    // Atomic buffer swap - display will use new data on next scan cycle
-    int temp = active_buffer;
-    active_buffer = write_buffer;
-    write_buffer = temp;
 }
 
-// LD pin array: static DRAM (flash cache pause'dan etkilenmez)
-static const gpio_num_t s_ld_pins[8] = {
-    CD4543_LD1_PIN, CD4543_LD2_PIN, CD4543_LD3_PIN, CD4543_LD4_PIN,
-    CD4543_LD5_PIN, CD4543_LD6_PIN, CD4543_LD7_PIN, CD4543_LD8_PIN,
+void andon_display_invalidate(uint32_t dirty_mask) {
+    atomic_fetch_add_explicit(&s_stat_render_requests, 1, memory_order_relaxed);
+    if (s_render_task == NULL) {
+        return;  // Init henüz yapılmadı; init zaten tam render ister
+    }
+    xTaskNotify(s_render_task, dirty_mask, eSetBits);
+}
+
+#if ANDON_DISPLAY_BACKEND != DISPLAY_BACKEND_I2S_DMA
+// ============ Tarayıcı (tüketici) tarafı ============
+// Frame başında en yeni yayınlanmış frame'e geç ve seq'ini not al
+static DRAM_ATTR uint32_t s_front = 0;
+static DRAM_ATTR uint32_t s_front_seq = 0;
+
+static const scan_frame_t *IRAM_ATTR display_frame_acquire(void) {
+    if (atomic_load_explicit(&s_latest, memory_order_relaxed) & FRAME_FRESH) {
+        uint32_t prev = atomic_exchange_explicit(&s_latest, s_front, memory_order_acq_rel);
+        s_front = prev & FRAME_INDEX_MASK;
+    }
+    const scan_frame_t *frame = &scan_frames[s_front];
+    s_front_seq = atomic_load_explicit(&frame->seq, memory_order_acquire);
+    return frame;
+}
+
+// Frame sonunda: oynatılırken frame değiştiyse (olmamalı) yırtık say
+static void IRAM_ATTR display_frame_release(const scan_frame_t *frame) {
+    atomic_thread_fence(memory_order_acquire);
+    uint32_t seq = atomic_load_explicit(&frame->seq, memory_order_relaxed);
+    if (seq != s_front_seq || (seq & 1U)) {
+        s_stat_torn_frames++;
+    }
+}
+
+// ============ Latch Durumu (gereksiz CD4543 yazımlarını atla) ============
+// CD4543, LD LOW iken son değeri tutar: aynı değer tekrar gerekiyorsa data
+// kurulumu ve strobe atlanır (blank haneler, ardışık eşit rakamlar).
+#define LATCH_VALUE_UNKNOWN  0xFFFFFFFFUL
+
+static DRAM_ATTR uint32_t s_latched[8] = {
+    LATCH_VALUE_UNKNOWN, LATCH_VALUE_UNKNOWN, LATCH_VALUE_UNKNOWN, LATCH_VALUE_UNKNOWN,
+    LATCH_VALUE_UNKNOWN, LATCH_VALUE_UNKNOWN, LATCH_VALUE_UNKNOWN, LATCH_VALUE_UNKNOWN,
 };
+#endif // ANDON_DISPLAY_BACKEND != DISPLAY_BACKEND_I2S_DMA
+
+static volatile uint32_t s_stat_latch_writes = 0;
+static volatile uint32_t s_stat_latch_skipped = 0;
+
+// ============ Tarama İstatistikleri (refresh rate / jitter) ============
+// Tek yazıcı: tarama task'ı. Okuyucu pencereyi sıfırlamak için
+// sadece istek bayrağını kaldırır, sıfırlamayı bir sonraki frame'de yazıcı yapar.
+static volatile uint32_t s_stat_frames = 0;         // Toplam tam frame (6 tarama)
+static volatile uint32_t s_stat_win_frames = 0;     // Penceredeki frame süresi örnek sayısı
+static volatile uint32_t s_stat_win_sum_us = 0;
+static volatile uint32_t s_stat_win_min_us = UINT32_MAX;
+static volatile uint32_t s_stat_win_max_us = 0;
+static volatile bool s_stat_reset_req = false;
+
+#if ANDON_DISPLAY_BACKEND != DISPLAY_BACKEND_I2S_DMA
+static int64_t s_stat_last_frame_us = 0;
+
+static void IRAM_ATTR display_stats_frame_start(void) {
+    int64_t now_us = esp_timer_get_time();
+
+    if (s_stat_reset_req) {
+        s_stat_win_frames = 0;
+        s_stat_win_sum_us = 0;
+        s_stat_win_min_us = UINT32_MAX;
+        s_stat_win_max_us = 0;
+        s_stat_reset_req = false;
+    } else if (s_stat_last_frame_us != 0) {
+        uint32_t period_us = (uint32_t)(now_us - s_stat_last_frame_us);
+        s_stat_win_sum_us += period_us;
+        s_stat_win_frames++;
+        if (period_us < s_stat_win_min_us) s_stat_win_min_us = period_us;
+        if (period_us > s_stat_win_max_us) s_stat_win_max_us = period_us;
+    }
+
+    s_stat_last_frame_us = now_us;
+    s_stat_frames++;
+}
+
+static void IRAM_ATTR display_stats_frame_break(void) {
+    // Ekran kapandıysa aradaki boşluk frame süresi olarak sayılmasın
+    s_stat_last_frame_us = 0;
+}
+#endif // ANDON_DISPLAY_BACKEND != DISPLAY_BACKEND_I2S_DMA
+
+#if ANDON_DISPLAY_BACKEND == DISPLAY_BACKEND_I2S_DMA
+// ============ Display Scan: I2S0 Paralel (LCD) Modu + DMA ============
+// Frame, display_waveform ile 16-bit örneklere derlenir ve kendine bağlı bir
+// DMA descriptor'ı üzerinden sürekli tekrar oynatılır: tarama için CPU kullanılmaz.
+// Veri değişince boştaki buffer derlenir ve aktif descriptor'ın next'i ona
+// çevrilir; geçiş frame sınırında olur (yırtılma yok).
+//
+// Örnek hızı display_waveform.h'deki bölücülerden gelir (100 kHz, 10us/örnek)
+#define DISPLAY_I2S_FRAME_US    DISPLAY_WAVE_FRAME_US
+
+_Static_assert(DISPLAY_WAVE_FRAME_SAMPLES * 2 <= 4095, "Frame tek DMA descriptor'a sığmalı");
+
+static DMA_ATTR uint16_t s_wave_buf[2][DISPLAY_WAVE_FRAME_SAMPLES];
+static DMA_ATTR lldesc_t s_wave_desc[2];
+static int s_wave_active = 0;                   // DMA'nın oynattığı buffer
+static int64_t s_wave_swap_us = 0;              // Son buffer geçişi zamanı
+static uint8_t s_wave_last_data[6][8];          // Son derlenen tarama verisi
+static bool s_wave_last_screen_on = false;
+static bool s_wave_started = false;
 
+static void display_wave_desc_init(int idx) {
+    lldesc_t *d = &s_wave_desc[idx];
+    d->size = sizeof(s_wave_buf[idx]);
+    d->length = sizeof(s_wave_buf[idx]);
+    d->offset = 0;
+    d->sosf = 0;
+    d->eof = 0;
+    d->owner = 1;  // DMA
+    d->buf = (const uint8_t *)s_wave_buf[idx];
+    d->qe.stqe_next = d;  // Kendi üzerinde döngü
+}
+
+static void display_wave_route_pins(void) {
+    // I2S0 16-bit LCD modunda veri hatları I2S0O_DATA_OUT8..23 sinyalleridir
+    const gpio_num_t wave_pins[DISPLAY_WAVE_NUM_BITS] = {
+        CD4543_D0_PIN, CD4543_D1_PIN, CD4543_D2_PIN, CD4543_D3_PIN,
+        HC138_A0_PIN, HC138_A1_PIN, HC138_A2_PIN,
+        CD4543_LD1_PIN, CD4543_LD2_PIN, CD4543_LD3_PIN, CD4543_LD4_PIN,
+        CD4543_LD5_PIN, CD4543_LD6_PIN, CD4543_LD7_PIN, CD4543_LD8_PIN,
+    };
+    for (int bit = 0; bit < DISPLAY_WAVE_NUM_BITS; bit++) {
+        esp_rom_gpio_connect_out_signal(wave_pins[bit], I2S0O_DATA_OUT8_IDX + bit, false, false);
+    }
+}
+
+static void display_wave_i2s_start(void) {
+    periph_module_enable(PERIPH_I2S0_MODULE);
+
+    // Reset
+    I2S0.conf.tx_reset = 1;
+    I2S0.conf.tx_reset = 0;
+    I2S0.conf.tx_fifo_reset = 1;
+    I2S0.conf.tx_fifo_reset = 0;
+    I2S0.lc_conf.out_rst = 1;
+    I2S0.lc_conf.out_rst = 0;
+    I2S0.lc_conf.ahbm_rst = 1;
+    I2S0.lc_conf.ahbm_rst = 0;
+    I2S0.lc_conf.ahbm_fifo_rst = 1;
+    I2S0.lc_conf.ahbm_fifo_rst = 0;
+
+    // Paralel LCD master TX, 16-bit tek kanal
+    I2S0.conf2.val = 0;
+    I2S0.conf2.lcd_en = 1;
+
+    I2S0.sample_rate_conf.val = 0;
+    I2S0.sample_rate_conf.tx_bits_mod = 16;
+    I2S0.sample_rate_conf.tx_bck_div_num = DISPLAY_WAVE_I2S_BCK_DIV;
+
+    I2S0.clkm_conf.val = 0;
+    I2S0.clkm_conf.clka_en = 0;  // PLL_D2 (160 MHz)
+    I2S0.clkm_conf.clkm_div_a = 1;
+    I2S0.clkm_conf.clkm_div_b = 0;
+    I2S0.clkm_conf.clkm_div_num = DISPLAY_WAVE_I2S_CLKM_DIV;
+
+    I2S0.fifo_conf.val = 0;
+    I2S0.fifo_conf.tx_fifo_mod_force_en = 1;
+    I2S0.fifo_conf.tx_fifo_mod = 1;  // 16-bit tek kanal
+    I2S0.fifo_conf.tx_data_num = 32;
+    I2S0.fifo_conf.dscr_en = 1;
+
+    I2S0.conf1.val = 0;
+    I2S0.conf1.tx_stop_en = 0;
+    I2S0.conf1.tx_pcm_bypass = 1;
+
+    I2S0.conf_chan.val = 0;
+    I2S0.conf_chan.tx_chan_mod = 1;
+    I2S0.timing = 0;
+    I2S0.pdm_conf.val = 0;
+
+    I2S0.lc_conf.val = 0;
+    I2S0.lc_conf.out_data_burst_en = 1;
+    I2S0.lc_conf.outdscr_burst_en = 1;
+
+    display_wave_route_pins();
+
+    I2S0.out_link.addr = ((uint32_t)(uintptr_t)&s_wave_desc[s_wave_active]) & 0xFFFFF;
+    I2S0.out_link.start = 1;
+    I2S0.conf.tx_start = 1;
+}
+
+// Tarama verisi değiştiyse boştaki buffer'ı derleyip DMA'yı ona geçir
+static void display_wave_publish(const uint8_t scan_data[6][8], bool screen_on) {
+    if (s_wave_started && screen_on == s_wave_last_screen_on &&
+        memcmp(s_wave_last_data, scan_data, sizeof(s_wave_last_data)) == 0) {
+        return;  // Değişiklik yok, DMA aynı frame'i oynatmaya devam eder
+    }
+
+    // Önceki geçiş henüz gerçekleşmemiş olabilir: en az bir frame bekle
+    while (s_wave_started && (esp_timer_get_time() - s_wave_swap_us) < (DISPLAY_I2S_FRAME_US + 1000)) {
+        vTaskDelay(1);
+    }
+
+    int next = s_wave_active ^ 1;
+    display_waveform_compile(scan_data, screen_on, true, s_wave_buf[next]);
+    display_wave_desc_init(next);
+
+    if (s_wave_started) {
+        // Aktif buffer bittiğinde DMA yeni buffer'a geçer ve orada döner
+        s_wave_desc[s_wave_active].qe.stqe_next = &s_wave_desc[next];
+    }
+    s_wave_active = next;
+    s_wave_swap_us = esp_timer_get_time();
+    memcpy(s_wave_last_data, scan_data, sizeof(s_wave_last_data));
+    s_wave_last_screen_on = screen_on;
+}
+
+#else
 // ============ Display Scan Task (Multiplexing) ============
 static void IRAM_ATTR display_scan_task(void *pvParameters) {
 
@@ -306,29 +755,42 @@ static void IRAM_ATTR display_scan_task(void *pvParameters) {
         // Ekran kapalıysa hiçbir şey gösterme
         if (!sys_data.screen_on) {
             andon_display_select_hane(7);  // Tüm taramalar OFF
+            display_stats_frame_break();
             vTaskDelay(pdMS_TO_TICKS(100));
             continue;
         }
         
         // Vardiya durdurulmuşsa ekran donuk kalır (güncellenmiyor ama gösteriliyor)
         // shift_state == SHIFT_STOPPED durumunda update yapılmaz ama scan devam eder
+        display_stats_frame_start();
+        const scan_frame_t *frame = display_frame_acquire();
         
         // 6 tarama döngüsü (0-5)
         for (int scan = 0; scan < 6; scan++) {
-            // 1. LATCH: Her scan'da 8 latch'e sırayla veri gönder
-            for (int latch = 0; latch < 8; latch++) {
-                uint8_t digit = SCAN_DATA_READ[scan][latch];
-                
+            // 1. LATCH: Her scan'da 8 latch'e sırayla programı oynat
+            // (latch zaten aynı değeri tutuyorsa atla)
+            const scan_step_t *st = frame->step[scan];
+            uint32_t skipped = 0;
+            for (int latch = 0; latch < 8; latch++, st++) {
+                if (s_latched[latch] == st->value) {
+                    skipped++;
+                    continue;
+                }
+                s_latched[latch] = st->value;
+
                 // BCD datası gönder
-                andon_display_send_bcd(digit);
-                esp_rom_delay_us(10);
+                GPIO.out_w1tc = st->data_clr;
+                GPIO.out_w1ts = st->data_set;
+                esp_rom_delay_us(20);
                 
                 // Latch pulse
-                gpio_set_level(s_ld_pins[latch], 1);
+                GPIO.out_w1ts = st->strobe;
                 esp_rom_delay_us(10);
-                gpio_set_level(s_ld_pins[latch], 0);
+                GPIO.out_w1tc = st->strobe;
                 esp_rom_delay_us(10);
             }
+            s_stat_latch_writes += 8 - skipped;
+            s_stat_latch_skipped += skipped;
             
             // 2. TARAMA: Latch'ler hazırlandıktan sonra taramayı seç
             andon_display_select_hane(scan);
@@ -340,11 +802,42 @@ static void IRAM_ATTR display_scan_task(void *pvParameters) {
             andon_display_select_hane(7);  // 7 = all off
             esp_rom_delay_us(5);
         }
+        display_frame_release(frame);
     
         // CPU'ya nefes
         vTaskDelay(1);
     }
 }
+#endif // ANDON_DISPLAY_BACKEND
+
+#if ANDON_DISPLAY_STATS_LOG_SEC > 0
+static void display_stats_log_cb(void *arg) {
+    andon_display_stats_t st;
+    andon_display_get_stats(&st);
+    ESP_LOGI(TAG, "Render: %lu requests/s -> %lu renders/s",
+             (unsigned long)st.render_requests_per_sec, (unsigned long)st.renders_per_sec);
+    ESP_LOGI(TAG, "Render: field renders LD1..LD8 = %lu/%lu/%lu/%lu/%lu/%lu/%lu/%lu",
+             (unsigned long)st.field_renders[0], (unsigned long)st.field_renders[1],
+             (unsigned long)st.field_renders[2], (unsigned long)st.field_renders[3],
+             (unsigned long)st.field_renders[4], (unsigned long)st.field_renders[5],
+             (unsigned long)st.field_renders[6], (unsigned long)st.field_renders[7]);
+    if (st.frame_period_avg_us == 0) {
+        return;  // Ekran kapalı veya henüz ölçüm yok
+    }
+    ESP_LOGI(TAG, "Scan: %lu.%lu Hz, period avg/min/max=%lu/%lu/%lu us, jitter=%lu us, latch write/skip=%lu/%lu per s",
+             (unsigned long)(10000000UL / st.frame_period_avg_us) / 10,
+             (unsigned long)(10000000UL / st.frame_period_avg_us) % 10,
+             (unsigned long)st.frame_period_avg_us,
+             (unsigned long)st.frame_period_min_us,
+             (unsigned long)st.frame_period_max_us,
+             (unsigned long)(st.frame_period_max_us - st.frame_period_min_us),
+             (unsigned long)st.latch_writes_per_sec,
+             (unsigned long)st.latch_skipped_per_sec);
+    if (st.torn_frames > 0) {
+        ESP_LOGW(TAG, "Scan: %lu torn frame(s) since boot", (unsigned long)st.torn_frames);
+    }
+}
+#endif
 
 // ============ GPIO Initialization ============
 static void gpio_init_display(void) {
@@ -389,13 +882,82 @@ static void gpio_init_display(void) {
 // ============ Public Functions ============
 
 esp_err_t andon_display_init(void) {
+    display_out_build_masks();
     gpio_init_display();
-    andon_display_update();
+    andon_display_select_hane(7);  // Tüm taramalar OFF
+#if ANDON_DISPLAY_BENCHMARK
+    display_out_benchmark();
+#endif
+    xTaskCreatePinnedToCore(display_render_task, "display_render", 4096, NULL, 5, &s_render_task, 0);
+    andon_display_invalidate(DISPLAY_DIRTY_ALL);  // İlk frame
     ESP_LOGI(TAG, "Andon display initialized");
     return ESP_OK;
 }
 
 void andon_display_start_task(void) {
+#if ANDON_DISPLAY_BACKEND == DISPLAY_BACKEND_I2S_DMA
+    // İlk frame'i render task derledi (init'teki bildirim, app_main'den yüksek öncelikli task'ı hemen çalıştırır)
+    display_wave_i2s_start();
+    s_wave_started = true;
+    ESP_LOGI(TAG, "Display scan DMA started (I2S0 16-bit, %d samples/frame, %d us/frame)",
+             DISPLAY_WAVE_FRAME_SAMPLES, DISPLAY_I2S_FRAME_US);
+#else
     xTaskCreatePinnedToCore(display_scan_task, "display_scan", 4096, NULL, 20, NULL, 0);
     ESP_LOGI(TAG, "Display scan task started (Core 0, Priority 20)");
+#endif
+
+#if ANDON_DISPLAY_STATS_LOG_SEC > 0
+    static esp_timer_handle_t s_stats_timer = NULL;
+    const esp_timer_create_args_t stats_timer_args = {
+        .callback = display_stats_log_cb,
+        .name = "disp_stats",
+    };
+    if (esp_timer_create(&stats_timer_args, &s_stats_timer) == ESP_OK) {
+        esp_timer_start_periodic(s_stats_timer, (uint64_t)ANDON_DISPLAY_STATS_LOG_SEC * 1000000ULL);
+    }
+#endif
+}
+
+void andon_display_get_stats(andon_display_stats_t *out) {
+    if (out == NULL) {
+        return;
+    }
+    static int64_t s_last_get_us = 0;
+    static uint32_t s_last_writes = 0;
+    static uint32_t s_last_skipped = 0;
+    static uint32_t s_last_requests = 0;
+    static uint32_t s_last_published = 0;
+
+    uint32_t win_frames = s_stat_win_frames;
+    uint32_t win_sum_us = s_stat_win_sum_us;
+    uint32_t writes = s_stat_latch_writes;
+    uint32_t skipped = s_stat_latch_skipped;
+    uint32_t requests = atomic_load_explicit(&s_stat_render_requests, memory_order_relaxed);
+    uint32_t published = s_stat_published;
+    int64_t now_us = esp_timer_get_time();
+    uint32_t elapsed_ms = (s_last_get_us != 0) ? (uint32_t)((now_us - s_last_get_us) / 1000) : 0;
+
+    out->frames = s_stat_frames;
+    out->frame_period_avg_us = (win_frames > 0) ? (win_sum_us / win_frames) : 0;
+    out->frame_period_min_us = (win_frames > 0) ? s_stat_win_min_us : 0;
+    out->frame_period_max_us = (win_frames > 0) ? s_stat_win_max_us : 0;
+    out->latch_writes_per_sec = (elapsed_ms > 0) ? (uint32_t)((uint64_t)(writes - s_last_writes) * 1000 / elapsed_ms) : 0;
+    out->frames_published = published;
+    out->torn_frames = s_stat_torn_frames;
+    for (int field = 0; field < DISPLAY_FIELD_COUNT; field++) {
+        out->field_renders[field] = s_stat_field_renders[field];
+        out->field_rendered_at[field] = s_stat_field_rendered_at[field];
+    }
+    out->latch_skipped_per_sec = (elapsed_ms > 0) ? (uint32_t)((uint64_t)(skipped - s_last_skipped) * 1000 / elapsed_ms) : 0;
+    out->render_requests_per_sec = (elapsed_ms > 0) ? (uint32_t)((uint64_t)(requests - s_last_requests) * 1000 / elapsed_ms) : 0;
+    out->renders_per_sec = (elapsed_ms > 0) ? (uint32_t)((uint64_t)(published - s_last_published) * 1000 / elapsed_ms) : 0;
+
+    s_last_get_us = now_us;
+    s_last_writes = writes;
+    s_last_skipped = skipped;
+    s_last_requests = requests;
+    s_last_published = published;
+
+    // Yeni ölçüm penceresi (sıfırlamayı tarama tarafı yapar)
+    s_stat_reset_req = true;
 }
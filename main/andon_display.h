@@ -21,21 +21,99 @@
 // Blank display value (CD4543)
 #define DISPLAY_BLANK    0x0F
 
+// 1: init sırasında gpio_set_level ve register çıkış yolu için cycle ölçümü logla
+#ifndef ANDON_DISPLAY_BENCHMARK
+#define ANDON_DISPLAY_BENCHMARK  0
+#endif
+
+// ============ Tarama Backend Seçimi ============
+#define DISPLAY_BACKEND_TASK        0   // Busy-wait scan task (Core 0, Priority 20)
+#define DISPLAY_BACKEND_I2S_DMA     2   // I2S0 paralel mod + DMA, CPU kullanmaz
+
+// Varsayılan orijinal tarama task'ı. I2S_DMA için panelde refresh ve jitter
+// henüz ölçülmedi: "Scan:" istatistik logu karşılaştırılmadan değişmez.
+// (1 ayrılmış: gptimer ISR backend'i ölçülmeden geri eklenmez.)
+#ifndef ANDON_DISPLAY_BACKEND
+#define ANDON_DISPLAY_BACKEND   DISPLAY_BACKEND_TASK
+#endif
+#if ANDON_DISPLAY_BACKEND != DISPLAY_BACKEND_TASK && ANDON_DISPLAY_BACKEND != DISPLAY_BACKEND_I2S_DMA
+#error "ANDON_DISPLAY_BACKEND: DISPLAY_BACKEND_TASK veya DISPLAY_BACKEND_I2S_DMA olmalı"
+#endif
+
+// Tarama periyodu (6 tarama = 1 frame). Orijinal task taraması ve I2S dalga
+// formu aynı: 8 latch x 30us + 1200us bekleme = 1440us, frame 8.64ms (~115.7 Hz)
+#define DISPLAY_SCAN_PERIOD_US      1440
+
+// ============ Render (dirty bildirimleri) ============
+// Ekran alanları: andon_display_invalidate ile değişen alanlar bildirilir
+#define DISPLAY_DIRTY_CLOCK     (1U << 0)   // LD1: Saat
+#define DISPLAY_DIRTY_DURUS     (1U << 1)   // LD2: Duruş süresi
+#define DISPLAY_DIRTY_COUNTERS  (1U << 2)   // LD3-5, LD7, LD8: Süreler, gerçekleşen, verim
+#define DISPLAY_DIRTY_TARGET    (1U << 3)   // LD6, LD8: Hedef adet, verim
+#define DISPLAY_DIRTY_MENU      (1U << 4)   // Menü/ayar ekranı (tüm alanlar)
+#define DISPLAY_DIRTY_ALL       0x1FU
+
+// Ekran alanları (alan indeksi = CD4543 latch indeksi, LD1 = 0)
+typedef enum {
+    DISPLAY_FIELD_SAAT = 0,     // LD1
+    DISPLAY_FIELD_DURUS,        // LD2
+    DISPLAY_FIELD_CALISMA,      // LD3
+    DISPLAY_FIELD_ATIL,         // LD4
+    DISPLAY_FIELD_PLANLI,       // LD5
+    DISPLAY_FIELD_HEDEF,        // LD6
+    DISPLAY_FIELD_GERCEKLESEN,  // LD7
+    DISPLAY_FIELD_VERIM,        // LD8
+    DISPLAY_FIELD_COUNT
+} display_field_t;
+
+// Render task'ın iki render arasındaki minimum süresi (bu sürede gelen istekler birleşir)
+#ifndef DISPLAY_RENDER_PERIOD_MS
+#define DISPLAY_RENDER_PERIOD_MS    50
+#endif
+
+// Refresh rate / jitter logu periyodu (0 = kapalı)
+#ifndef ANDON_DISPLAY_STATS_LOG_SEC
+#define ANDON_DISPLAY_STATS_LOG_SEC 60
+#endif
+
+// Tarama istatistikleri (son andon_display_get_stats çağrısından bu yana)
+typedef struct {
+    uint32_t frames;                // Toplam tam frame (6 tarama) sayısı
+    uint32_t frame_period_avg_us;   // Ortalama frame süresi (0 = ölçüm yok)
+    uint32_t frame_period_min_us;
+    uint32_t frame_period_max_us;   // max - min = jitter
+    uint32_t latch_writes_per_sec;  // Yapılan CD4543 latch yazımı
+    uint32_t latch_skipped_per_sec; // Değer aynı olduğu için atlanan latch yazımı
+    uint32_t frames_published;      // Toplam yayınlanan (render edilen) frame
+    uint32_t torn_frames;           // Oynatılırken değişen frame sayısı (0 olmalı)
+    uint32_t render_requests_per_sec; // andon_display_invalidate çağrısı
+    uint32_t renders_per_sec;       // Render task'ın yayınladığı frame
+    uint32_t field_renders[DISPLAY_FIELD_COUNT];     // Alanın yeniden formatlanma sayısı (açılıştan beri)
+    uint32_t field_rendered_at[DISPLAY_FIELD_COUNT]; // Alanın son formatlandığı frame (frames_published)
+} andon_display_stats_t;
+
 /**
- * @brief Display modülünü başlat
+ * @brief Display modülünü başlat (render task'ı oluşturur ve ilk frame'i ister)
  * @return ESP_OK başarılı
  */
 esp_err_t andon_display_init(void);
 
 /**
- * @brief Display scan task'ını başlat
+ * @brief Display taramasını başlat (seçili backend: task veya I2S DMA)
  */
 void andon_display_start_task(void);
 
 /**
- * @brief Scan data'yı güncelle (sistem verilerinden)
+ * @brief Değişen ekran alanlarını render task'a bildir (bloklamaz, render yapmaz)
+ * @param dirty_mask DISPLAY_DIRTY_* bitleri
+ */
+void andon_display_invalidate(uint32_t dirty_mask);
+
+/**
+ * @brief Tarama istatistiklerini al ve ölçüm penceresini sıfırla
+ * @param out Çıktı istatistikleri
  */
-void andon_display_update(void);
+void andon_display_get_stats(andon_display_stats_t *out);
 
 
 #endif // ANDON_DISPLAY_H
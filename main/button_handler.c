@@ -1,13 +1,21 @@
 /*
  * KlimasanAndonV2 - Button Handler Module
  * 4 buton: Yeşil (WORK), Kırmızı (IDLE), Sarı (PLANNED), Turuncu (Adet+1)
+ *
+ * Her kenar GPIO kesmesinde zaman damgalanır ve butonun one-shot debounce
+ * timer'ı yeniden kurulur. Timer son kenardan DEBOUNCE_US sonra seviyeyi
+ * okur: onaylı seviye değiştiyse olay kuyruğa yazılır. Task olay gelene
+ * kadar uyur.
  */
 #include <stdint.h>
 #include <stdbool.h>
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
 #include "driver/gpio.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 
 #include "button_handler.h"
 #include "pin_config.h"
@@ -18,93 +26,104 @@ static const char *TAG = "button_handler";
 static button_callback_t g_button_callback = NULL;
 
 // Debounce parameters
-#define DEBOUNCE_MS     150
-#define RELEASE_MS      80
+#define BUTTON_COUNT        4
+#define DEBOUNCE_US         (30 * 1000)     // Son kenardan sonra seviye bu kadar sabit kalmalı
+#define BUTTON_QUEUE_LEN    8
+
+// active_level: buton basıldığında GPIO'nun aldığı değer
+// NO (Normal-Open, aktif-LOW) = 0
+// NC (Normal-Closed, aktif-HIGH) = 1  ← Kırmızı buton NC kontak
+typedef struct {
+    gpio_num_t pin;
+    uint8_t active_level;
+    button_event_t event;
+    const char *name;
+} button_def_t;
+
+static const button_def_t s_buttons[BUTTON_COUNT] = {
+    { BUTTON_GREEN_PIN,  0, BUTTON_EVENT_GREEN,  "GREEN"  },
+    { BUTTON_RED_PIN,    1, BUTTON_EVENT_RED,    "RED"    },
+    { BUTTON_YELLOW_PIN, 0, BUTTON_EVENT_YELLOW, "YELLOW" },
+    { BUTTON_ORANGE_PIN, 0, BUTTON_EVENT_ORANGE, "ORANGE" },
+};
+
+typedef struct {
+    esp_timer_handle_t timer;   // One-shot debounce timer
+    int64_t edge_us;            // Onay bekleyen değişimin ilk kenarı (s_edge_mux altında)
+    bool pending;               // Kenar görüldü, timer henüz bakmadı (s_edge_mux altında)
+    bool pressed;               // Onaylı seviye (sadece timer callback yazar)
+} button_state_t;
+
+static button_state_t s_state[BUTTON_COUNT];
+
+// edge_us + pending çifti GPIO ISR ile esp_timer task'ı arasında paylaşılır
+// (farklı çekirdekler olabilir). Callback ikisini tek adımda alıp temizler;
+// aksi halde okuma ile temizleme arasına düşen kenar kaybolur ve sonraki
+// basış eski zaman damgasını raporlar. 64-bit damga da yırtılmadan okunur.
+static portMUX_TYPE s_edge_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Onaylı basış (timer callback → task)
+typedef struct {
+    uint8_t index;
+    int64_t timestamp_us;
+} button_msg_t;
+
+static QueueHandle_t s_button_queue = NULL;
+
+// ============ ISR / Debounce Timer ============
+
+static void IRAM_ATTR button_isr(void *arg) {
+    button_state_t *st = &s_state[(uint32_t)(uintptr_t)arg];
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL_ISR(&s_edge_mux);
+    if (!st->pending) {
+        st->edge_us = now;
+        st->pending = true;
+    }
+    taskEXIT_CRITICAL_ISR(&s_edge_mux);
+    // Zıplama sürdükçe onay penceresi son kenardan yeniden başlar
+    esp_timer_stop(st->timer);
+    esp_timer_start_once(st->timer, DEBOUNCE_US);
+}
 
-// ============ Button Task ============
+static void button_debounce_cb(void *arg) {
+    uint32_t i = (uint32_t)(uintptr_t)arg;
+    button_state_t *st = &s_state[i];
+    taskENTER_CRITICAL(&s_edge_mux);
+    int64_t edge_us = st->edge_us;
+    st->pending = false;
+    taskEXIT_CRITICAL(&s_edge_mux);
+
+    bool pressed = (gpio_get_level(s_buttons[i].pin) == s_buttons[i].active_level);
+    if (pressed == st->pressed) {
+        return;     // Gürültü: seviye eski haline döndü
+    }
+    st->pressed = pressed;
+    if (!pressed) {
+        return;     // Bırakma sadece durumu günceller
+    }
 
-static void button_task(void *pvParameters) {
-    // active_level: buton basıldığında GPIO'nun aldığı değer
-    // NO (Normal-Open, aktif-LOW) = 0
-    // NC (Normal-Closed, aktif-HIGH) = 1  ← Kırmızı buton NC kontak
-    const uint8_t active_level[4] = {0, 1, 0, 0}; // Yeşil, Kırmızı, Sarı, Turuncu
-
-    // Başlangıç durumu: buton bırakılmış (idle) seviyesi = 1 - active_level
-    uint8_t last_state[4] = {
-        (uint8_t)(1 - active_level[0]),
-        (uint8_t)(1 - active_level[1]),
-        (uint8_t)(1 - active_level[2]),
-        (uint8_t)(1 - active_level[3]),
-    };
-    uint32_t last_press_time[4] = {0, 0, 0, 0};
-    bool button_held[4] = {false, false, false, false};
-    uint32_t release_duration[4] = {0, 0, 0, 0};
-
-    const gpio_num_t btn_pins[4] = {
-        BUTTON_GREEN_PIN,
-        BUTTON_RED_PIN,
-        BUTTON_YELLOW_PIN,
-        BUTTON_ORANGE_PIN
-    };
+    button_msg_t msg = { .index = (uint8_t)i, .timestamp_us = edge_us };
+    if (xQueueSend(s_button_queue, &msg, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "%s press dropped (queue full)", s_buttons[i].name);
+    }
+}
 
-    const button_event_t btn_events[4] = {
-        BUTTON_EVENT_GREEN,
-        BUTTON_EVENT_RED,
-        BUTTON_EVENT_YELLOW,
-        BUTTON_EVENT_ORANGE
-    };
+// ============ Button Task ============
 
-    const char *btn_names[4] = {"GREEN", "RED", "YELLOW", "ORANGE"};
+static void button_task(void *pvParameters) {
+    button_msg_t msg;
 
-    ESP_LOGI(TAG, "Button task started (4 buttons, RED=NC)");
+    ESP_LOGI(TAG, "Button task started (4 buttons, RED=NC, debounce %d ms)", DEBOUNCE_US / 1000);
 
     while (1) {
-        vTaskDelay(10 / portTICK_PERIOD_MS);
-
-        uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-
-        // === DIAGNOSIS: Her 2 saniyede ham GPIO değerlerini logla ===
-        static uint32_t diag_counter = 0;
-        if (++diag_counter >= 200) {  // 200 * 10ms = 2 saniye
-            diag_counter = 0;
-            ESP_LOGI(TAG, "BTN RAW: GREEN(G%d)=%d  RED(G%d)=%d  YELLOW(G%d)=%d  ORANGE(G%d)=%d",
-                btn_pins[0], gpio_get_level(btn_pins[0]),
-                btn_pins[1], gpio_get_level(btn_pins[1]),
-                btn_pins[2], gpio_get_level(btn_pins[2]),
-                btn_pins[3], gpio_get_level(btn_pins[3]));
-        }
+        xQueueReceive(s_button_queue, &msg, portMAX_DELAY);
 
-        for (int i = 0; i < 4; i++) {
-            uint8_t raw = gpio_get_level(btn_pins[i]);
-            uint8_t pressed = (raw == active_level[i]) ? 1 : 0;  // 1=basılı, 0=serbest
-            uint8_t last_pressed = (last_state[i] == active_level[i]) ? 1 : 0;
-
-            // Press edge: serbest → basılı
-            if (pressed && !last_pressed && !button_held[i]) {
-                if ((current_time - last_press_time[i]) > DEBOUNCE_MS) {
-                    ESP_LOGI(TAG, "%s button pressed", btn_names[i]);
-                    if (g_button_callback) {
-                        g_button_callback(btn_events[i]);
-                    }
-                    last_press_time[i] = current_time;
-                    button_held[i] = true;
-                    release_duration[i] = 0;
-                }
-            }
-
-            // Release detection
-            if (pressed) {
-                release_duration[i] = 0;
-            } else {
-                if (release_duration[i] < RELEASE_MS) {
-                    release_duration[i] += 10;
-                }
-                if (button_held[i] && release_duration[i] >= RELEASE_MS) {
-                    button_held[i] = false;
-                }
-            }
-
-            last_state[i] = raw;
+        const button_def_t *btn = &s_buttons[msg.index];
+        ESP_LOGI(TAG, "%s button pressed (+%lld us)", btn->name,
+                 (long long)(esp_timer_get_time() - msg.timestamp_us));
+        if (g_button_callback) {
+            g_button_callback(btn->event, msg.timestamp_us);
         }
     }
 }
@@ -112,34 +131,66 @@ static void button_task(void *pvParameters) {
 
 // ============ GPIO Initialization ============
 
-static void gpio_init_buttons(void) {
+static esp_err_t gpio_init_buttons(void) {
     gpio_config_t io_conf_buttons = {
         .pin_bit_mask = (1ULL << BUTTON_GREEN_PIN) | (1ULL << BUTTON_RED_PIN) | 
                         (1ULL << BUTTON_YELLOW_PIN) | (1ULL << BUTTON_ORANGE_PIN),
         .mode = GPIO_MODE_INPUT,
         .pull_up_en = GPIO_PULLUP_DISABLE,  // GPIO 34-39 dahili pullup yok
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_ANYEDGE,
     };
     gpio_config(&io_conf_buttons);
-    ESP_LOGI(TAG, "Button GPIO initialized (Pins %d, %d, %d, %d)", 
+
+    esp_err_t ret = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {  // Başka modül kurmuş olabilir
+        ESP_LOGE(TAG, "GPIO ISR service failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    for (uint32_t i = 0; i < BUTTON_COUNT; i++) {
+        const esp_timer_create_args_t args = {
+            .callback = button_debounce_cb,
+            .arg = (void *)(uintptr_t)i,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "btn_debounce",
+        };
+        ret = esp_timer_create(&args, &s_state[i].timer);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Debounce timer failed: %s", esp_err_to_name(ret));
+            return ret;
+        }
+        // Açılışta basılı duran buton olay üretmez
+        s_state[i].pressed = (gpio_get_level(s_buttons[i].pin) == s_buttons[i].active_level);
+        s_state[i].pending = false;
+        gpio_isr_handler_add(s_buttons[i].pin, button_isr, (void *)(uintptr_t)i);
+    }
+
+    ESP_LOGI(TAG, "Button GPIO initialized (Pins %d, %d, %d, %d, any-edge IRQ)", 
              BUTTON_GREEN_PIN, BUTTON_RED_PIN, BUTTON_YELLOW_PIN, BUTTON_ORANGE_PIN);
+    return ESP_OK;
 }
 
 // ============ Public Functions ============
 
 esp_err_t button_handler_init(void) {
-    gpio_init_buttons();
+    s_button_queue = xQueueCreate(BUTTON_QUEUE_LEN, sizeof(button_msg_t));
+    if (s_button_queue == NULL) {
+        ESP_LOGE(TAG, "Button queue alloc failed");
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t ret = gpio_init_buttons();
     ESP_LOGI(TAG, "Button handler initialized");
-    return ESP_OK;
+    return ret;
 }
 
 void button_handler_start_task(void) {
     TaskHandle_t handle = NULL;
-    BaseType_t ret = xTaskCreatePinnedToCore(button_task, "button_task", 8192, NULL, 6, &handle, 1);
+    BaseType_t ret = xTaskCreatePinnedToCore(button_task, "button_task", 4096, NULL, 6, &handle, 1);
     if (ret != pdPASS || handle == NULL) {
         ESP_LOGE(TAG, "Button task creation FAILED! ret=%d", ret);
     } else {
-        ESP_LOGI(TAG, "Button task started (Core 1, Priority 6, Stack 8192)");
+        ESP_LOGI(TAG, "Button task started (Core 1, Priority 6, Stack 4096)");
     }
 }
 
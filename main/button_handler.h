@@ -1,6 +1,7 @@
 /*
  * KlimasanAndonV2 - Button Handler Module
  * 4 buton: Yeşil (WORK), Kırmızı (IDLE), Sarı (PLANNED), Turuncu (Adet+1)
+ * Kenar kesmesi + buton başına one-shot esp_timer ile debounce
  */
 #ifndef BUTTON_HANDLER_H
 #define BUTTON_HANDLER_H
@@ -18,7 +19,8 @@ typedef enum {
 } button_event_t;
 
 // Buton callback tipi
-typedef void (*button_callback_t)(button_event_t event);
+// timestamp_us: basışın ilk kenarı (esp_timer_get_time), debounce onayından önce
+typedef void (*button_callback_t)(button_event_t event, int64_t timestamp_us);
 
 /**
  * @brief Buton modülünü başlat
@@ -0,0 +1,34 @@
+/*
+ * KlimasanAndonV2 - Cycle Sayacı
+ * Tek atomik sayaç: artırma fetch_add, sıfırlama store. Aynı değişken
+ * üzerinde oldukları için sıralıdırlar; kesme maskelenmez, kilit yoktur.
+ */
+#include <stdatomic.h>
+
+#include "cycle_counter.h"
+
+// Bağımsız sayaç: relaxed. s_running release ile yazılır: görünür olduğunda
+// sıfırlanmış sayaç da görünür.
+static _Atomic uint32_t s_frames = 0;
+static _Atomic bool s_running = false;
+
+void cycle_counter_start(uint32_t frames) {
+    atomic_store_explicit(&s_frames, frames, memory_order_relaxed);
+    atomic_store_explicit(&s_running, true, memory_order_release);
+}
+
+void cycle_counter_stop(void) {
+    atomic_store_explicit(&s_running, false, memory_order_relaxed);
+}
+
+bool cycle_counter_running(void) {
+    return atomic_load_explicit(&s_running, memory_order_acquire);
+}
+
+uint32_t cycle_counter_advance(void) {
+    return atomic_fetch_add_explicit(&s_frames, 1, memory_order_relaxed) + 1;
+}
+
+uint32_t cycle_counter_frames(void) {
+    return atomic_load_explicit(&s_frames, memory_order_relaxed);
+}
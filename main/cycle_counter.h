@@ -0,0 +1,41 @@
+/*
+ * KlimasanAndonV2 - Cycle Sayacı
+ * LED barın cycle ilerlemesi (frame sayısı, 30 frame = 1 sn) ve çalışıyor
+ * bayrağı. Artırma LED task'ında, sıfırlama buton/IR/parça olayında
+ * (controller) yapılır: ikisi yarışsa da artış kaybolmaz, değer yırtılmaz.
+ */
+#ifndef CYCLE_COUNTER_H
+#define CYCLE_COUNTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Cycle'ı verilen frame sayısından başlat (sıfırlama)
+ * @param frames Başlangıç değeri (geçmiş zaman damgasından hesaplanan)
+ */
+void cycle_counter_start(uint32_t frames);
+
+/**
+ * @brief Cycle'ı durdur (sayaç değeri korunur)
+ */
+void cycle_counter_stop(void);
+
+/**
+ * @brief Cycle çalışıyor mu
+ * true görüldüyse önceki cycle_counter_start'ın değeri de görünür.
+ */
+bool cycle_counter_running(void);
+
+/**
+ * @brief Bir frame ilerlet (LED task'ı, sadece WORK modunda)
+ * @return Yeni değer
+ */
+uint32_t cycle_counter_advance(void);
+
+/**
+ * @brief Güncel frame sayısı
+ */
+uint32_t cycle_counter_frames(void);
+
+#endif // CYCLE_COUNTER_H
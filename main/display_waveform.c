@@ -0,0 +1,49 @@
+/*
+ * KlimasanAndonV2 - Display Waveform Compiler
+ * Tarama frame'ini paralel çıkış örneklerine derler (bkz. display_waveform.h)
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "display_waveform.h"
+
+static inline uint16_t wave_bcd(uint8_t value) {
+    return (uint16_t)((value & 0x0F) << DISPLAY_WAVE_BIT_D0);
+}
+
+static inline uint16_t wave_hane(int hane) {
+    return (uint16_t)((hane & 0x07) << DISPLAY_WAVE_BIT_A0);
+}
+
+static inline uint16_t wave_ld(int latch) {
+    return (uint16_t)(1U << (DISPLAY_WAVE_BIT_LD1 + latch));
+}
+
+static inline void wave_fill(uint16_t *out, int *pos, uint16_t word, int count, bool swap_pairs) {
+    for (int i = 0; i < count; i++) {
+        int idx = swap_pairs ? (*pos ^ 1) : *pos;
+        out[idx] = word;
+        (*pos)++;
+    }
+}
+
+void display_waveform_compile(const uint8_t scan_data[6][8], bool screen_on,
+                              bool swap_pairs, uint16_t *out) {
+    const uint16_t hane_off = wave_hane(DISPLAY_WAVE_HANE_OFF);
+    int pos = 0;
+
+    for (int scan = 0; scan < 6; scan++) {
+        // 1. LATCH: HC138 kapalıyken 8 latch'e bu taramanın verisi
+        for (int latch = 0; latch < 8; latch++) {
+            uint16_t data = hane_off | wave_bcd(scan_data[scan][latch]);
+            wave_fill(out, &pos, data, DISPLAY_WAVE_STEP_SAMPLES, swap_pairs);
+            wave_fill(out, &pos, data | wave_ld(latch), DISPLAY_WAVE_STEP_SAMPLES, swap_pairs);
+            wave_fill(out, &pos, data, DISPLAY_WAVE_STEP_SAMPLES, swap_pairs);
+        }
+
+        // 2. TARAMA + BEKLE: data hatları son değerde sabit, hane seçili
+        uint16_t last = wave_bcd(scan_data[scan][7]);
+        uint16_t dwell = screen_on ? (last | wave_hane(scan)) : (last | hane_off);
+        wave_fill(out, &pos, dwell, DISPLAY_WAVE_DWELL_SAMPLES, swap_pairs);
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ * KlimasanAndonV2 - Display Waveform Compiler
+ * Tarama frame'ini (6 tarama x 8 latch) paralel çıkış örneklerine derler
+ *
+ * Her örnek (16-bit) bir zaman diliminde tüm display pinlerinin seviyesidir:
+ *   bit 0-3  : CD4543 D0-D3 (BCD)
+ *   bit 4-6  : HC138 A0-A2 (7 = tüm taramalar OFF)
+ *   bit 7-14 : CD4543 LD1-LD8 (latch strobe)
+ *
+ * Bir tarama: 8 latch x (data kurulum + LD HIGH + LD LOW) sırasında HC138 = 7,
+ * ardından DWELL süresince seçili hane yanık kalır.
+ *
+ * Bu modül ESP-IDF'e bağımlı değildir; host üzerinde derlenip test edilebilir.
+ */
+#ifndef DISPLAY_WAVEFORM_H
+#define DISPLAY_WAVEFORM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============ Örnek Bit Düzeni ============
+#define DISPLAY_WAVE_BIT_D0         0
+#define DISPLAY_WAVE_BIT_A0         4
+#define DISPLAY_WAVE_BIT_LD1        7
+#define DISPLAY_WAVE_NUM_BITS       15
+
+#define DISPLAY_WAVE_HANE_OFF       7
+
+// ============ Zamanlama (örnek cinsinden) ============
+#define DISPLAY_WAVE_SAMPLE_US      10      // 1 örnek = 10us (100 kHz)
+#define DISPLAY_WAVE_STEP_SAMPLES   1       // Data kurulum / LD HIGH / LD LOW adımı
+#define DISPLAY_WAVE_DWELL_SAMPLES  120     // 1200us hane yanık kalma süresi
+
+#define DISPLAY_WAVE_LATCH_SAMPLES  (3 * DISPLAY_WAVE_STEP_SAMPLES)
+#define DISPLAY_WAVE_SCAN_SAMPLES   (8 * DISPLAY_WAVE_LATCH_SAMPLES + DISPLAY_WAVE_DWELL_SAMPLES)
+#define DISPLAY_WAVE_FRAME_SAMPLES  (6 * DISPLAY_WAVE_SCAN_SAMPLES)
+
+#define DISPLAY_WAVE_SCAN_US        (DISPLAY_WAVE_SCAN_SAMPLES * DISPLAY_WAVE_SAMPLE_US)
+#define DISPLAY_WAVE_FRAME_US       (DISPLAY_WAVE_FRAME_SAMPLES * DISPLAY_WAVE_SAMPLE_US)
+
+_Static_assert((DISPLAY_WAVE_FRAME_SAMPLES % 2) == 0, "Frame çift sayıda örnek olmalı (16-bit çift takası)");
+
+// ============ I2S0 Saat Bölücüleri (LCD modu) ============
+// Örnek hızı = PLL_D2 / (CLKM_DIV * BCK_DIV * 2) = 160 MHz / 1600 = 100 kHz
+#define DISPLAY_WAVE_I2S_SRC_HZ     160000000UL
+#define DISPLAY_WAVE_I2S_CLKM_DIV   200
+#define DISPLAY_WAVE_I2S_BCK_DIV    4
+#define DISPLAY_WAVE_I2S_SAMPLE_HZ  (DISPLAY_WAVE_I2S_SRC_HZ / (DISPLAY_WAVE_I2S_CLKM_DIV * DISPLAY_WAVE_I2S_BCK_DIV * 2))
+
+_Static_assert(DISPLAY_WAVE_I2S_SAMPLE_HZ * DISPLAY_WAVE_SAMPLE_US == 1000000UL,
+               "I2S bölücüleri DISPLAY_WAVE_SAMPLE_US ile uyuşmalı");
+
+/**
+ * @brief Tarama verisini frame örneklerine derle
+ * @param scan_data 6 tarama x 8 latch BCD değerleri (0x0F = blank)
+ * @param screen_on false ise tüm frame boyunca HC138 = 7 (ekran kapalı)
+ * @param swap_pairs true ise her 16-bit örnek çifti yer değiştirir
+ *                   (ESP32 I2S 16-bit modu çiftleri ters sırada çıkarır)
+ * @param out DISPLAY_WAVE_FRAME_SAMPLES uzunluğunda çıktı
+ */
+void display_waveform_compile(const uint8_t scan_data[6][8], bool screen_on,
+                              bool swap_pairs, uint16_t *out);
+
+#endif // DISPLAY_WAVEFORM_H
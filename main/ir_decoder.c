@@ -0,0 +1,341 @@
+/*
+ * KlimasanAndonV2 - IR Darbe Çözücü
+ * Sadece darbe sürelerine bakar: GPIO, zamanlayıcı veya log kullanmaz.
+ */
+#include <stddef.h>
+#include "ir_decoder.h"
+
+// Zaman pencereleri ir_decoder.h'de (derleme bayrağıyla ayarlanabilir)
+#define RC5_HALVES              28      // 14 bit
+
+#define IN_RANGE(d, lo, hi)     ((d) >= (lo) && (d) <= (hi))
+
+static const char *const s_protocol_names[IR_PROTO_COUNT] = {
+    [IR_PROTO_NEC]      = "NEC",
+    [IR_PROTO_NEC_EXT]  = "NEC-EXT",
+    [IR_PROTO_SAMSUNG]  = "SAMSUNG",
+    [IR_PROTO_RC5]      = "RC5",
+    [IR_PROTO_SIRC]     = "SIRC",
+};
+
+static uint32_t reverse_bits_32(uint32_t value) {
+    uint32_t reversed = 0;
+    for (int i = 0; i < 32; i++) {
+        reversed = (reversed << 1) | ((value >> i) & 1);
+    }
+    return reversed;
+}
+
+// ============ Pulse-distance (NEC / Samsung) ============
+#define PD_IDLE         0
+#define PD_LEADER       1   // Leader mark alındı, space bekleniyor
+#define PD_MARK         2   // Bit mark bekleniyor
+#define PD_SPACE        3   // Bit space bekleniyor
+#define PD_REPEAT_STOP  4   // Repeat space alındı, bitiş mark'ı bekleniyor
+
+typedef enum {
+    PD_NONE = 0,
+    PD_FRAME,
+    PD_REPEAT,
+} pd_result_t;
+
+static pd_result_t pd_feed(ir_pd_state_t *st, bool mark, uint32_t d,
+                           uint32_t leader_min, uint32_t leader_max, bool allow_repeat) {
+    if (mark) {
+        // Repeat ancak bitiş mark'ı gelince kabul edilir (gürültüde 9ms + 2.25ms tek başına yetmez)
+        if (st->state == PD_REPEAT_STOP && IN_RANGE(d, IR_PD_BIT_MARK_MIN, IR_PD_BIT_MARK_MAX)) {
+            st->state = PD_IDLE;
+            return PD_REPEAT;
+        }
+        if (IN_RANGE(d, leader_min, leader_max)) {
+            st->state = PD_LEADER;
+        } else if (st->state == PD_MARK && IN_RANGE(d, IR_PD_BIT_MARK_MIN, IR_PD_BIT_MARK_MAX)) {
+            st->state = PD_SPACE;
+        } else {
+            st->state = PD_IDLE;
+        }
+        return PD_NONE;
+    }
+
+    switch (st->state) {
+        case PD_LEADER:
+            if (IN_RANGE(d, IR_PD_LEADER_SPACE_MIN, IR_PD_LEADER_SPACE_MAX)) {
+                st->data = 0;
+                st->bit_count = 0;
+                st->state = PD_MARK;
+                return PD_NONE;
+            }
+            st->state = (allow_repeat && IN_RANGE(d, IR_NEC_REPEAT_SPACE_MIN, IR_NEC_REPEAT_SPACE_MAX)) ?
+                        PD_REPEAT_STOP : PD_IDLE;
+            return PD_NONE;
+
+        case PD_SPACE:
+            if (IN_RANGE(d, IR_PD_BIT_SPACE_MIN, IR_PD_BIT_SPACE_MAX)) {
+                st->data = (st->data << 1) | (d < IR_PD_BIT_SPACE_SPLIT ? 0 : 1);
+                if (++st->bit_count == 32) {
+                    st->state = PD_IDLE;
+                    return PD_FRAME;
+                }
+                st->state = PD_MARK;
+                return PD_NONE;
+            }
+            st->state = PD_IDLE;
+            return PD_NONE;
+
+        default:
+            st->state = PD_IDLE;
+            return PD_NONE;
+    }
+}
+
+// NEC çerçevesini sınıflandır. Standart NEC eski anahtar düzeniyle verilir:
+// address = ~command baytı, command = ~address baytı (mevcut tuş haritaları).
+// 0x33 ile başlayan non-standard kumanda checksum'sız kabul edilir.
+static bool nec_classify(ir_decoder_t *dec, uint32_t raw, ir_frame_t *out) {
+    bool is_non_standard = ((raw & 0xFF000000) == 0x33000000);
+    uint32_t code = reverse_bits_32(raw);
+
+    uint8_t b0 = code & 0xFF;               // address
+    uint8_t b1 = (code >> 8) & 0xFF;        // ~address (extended: address high)
+    uint8_t b2 = (code >> 16) & 0xFF;       // command
+    uint8_t b3 = (code >> 24) & 0xFF;       // ~command
+
+    if (is_non_standard || ((b0 ^ b1) == 0xFF && (b2 ^ b3) == 0xFF)) {
+        out->protocol = IR_PROTO_NEC;
+        out->address = b3;
+        out->command = b1;
+        return true;
+    }
+    if ((b2 ^ b3) == 0xFF) {
+        out->protocol = IR_PROTO_NEC_EXT;
+        out->address = (uint16_t)((b1 << 8) | b0);
+        out->command = b2;
+        return true;
+    }
+    dec->errors++;
+    return false;
+}
+
+static bool samsung_classify(ir_decoder_t *dec, uint32_t raw, ir_frame_t *out) {
+    uint32_t code = reverse_bits_32(raw);
+    uint8_t b0 = code & 0xFF;
+    uint8_t b1 = (code >> 8) & 0xFF;
+    uint8_t b2 = (code >> 16) & 0xFF;
+    uint8_t b3 = (code >> 24) & 0xFF;
+
+    if (b0 != b1 || (b2 ^ b3) != 0xFF) {
+        dec->errors++;
+        return false;
+    }
+    out->protocol = IR_PROTO_SAMSUNG;
+    out->address = b0;
+    out->command = b2;
+    return true;
+}
+
+// ============ RC5 (Manchester) ============
+
+static bool rc5_finish(ir_decoder_t *dec, ir_frame_t *out) {
+    ir_rc5_state_t *st = &dec->rc5;
+    uint32_t levels = st->levels;
+    uint16_t bits = 0;
+    st->halves = 0;
+
+    // Her bit iki zıt yarımdan oluşur; değer = ikinci yarım mark mı
+    for (int i = 0; i < RC5_HALVES; i += 2) {
+        bool first = (levels >> i) & 1;
+        bool second = (levels >> (i + 1)) & 1;
+        if (first == second) {
+            dec->errors++;
+            return false;
+        }
+        bits = (uint16_t)((bits << 1) | second);
+    }
+    if (!(bits & 0x2000)) {         // S1 her zaman 1
+        dec->errors++;
+        return false;
+    }
+    // S1 S2 T A4..A0 C5..C0; S2 = 0 ise RC5X (command bit 6)
+    out->protocol = IR_PROTO_RC5;
+    out->toggle = (bits >> 11) & 1;
+    out->address = (bits >> 6) & 0x1F;
+    out->command = (uint8_t)((bits & 0x3F) | ((bits & 0x1000) ? 0 : 0x40));
+    return true;
+}
+
+static void rc5_add_halves(ir_rc5_state_t *st, bool mark, int count) {
+    while (count-- > 0 && st->halves < RC5_HALVES) {
+        if (mark) st->levels |= (1UL << st->halves);
+        st->halves++;
+    }
+}
+
+static bool rc5_feed(ir_decoder_t *dec, bool mark, uint32_t d, ir_frame_t *out) {
+    ir_rc5_state_t *st = &dec->rc5;
+    int count = IN_RANGE(d, IR_RC5_HALF_MIN, IR_RC5_HALF_MAX) ? 1 :
+                IN_RANGE(d, IR_RC5_FULL_MIN, IR_RC5_FULL_MAX) ? 2 : 0;
+
+    if (st->halves == 0) {
+        // Başlangıç biti: ilk yarım (space) boşta görünmez, mark ile başlar
+        if (mark && count > 0) {
+            st->levels = 0;
+            st->halves = 1;
+            rc5_add_halves(st, true, count);
+        }
+        return false;
+    }
+
+    if (count == 0) {
+        // Uzun space: son bit 0 ise son yarımı (space) boşluğa karışmıştır
+        if (!mark && st->halves == RC5_HALVES - 1) {
+            st->halves = RC5_HALVES;
+            return rc5_finish(dec, out);
+        }
+        st->halves = 0;
+        return false;
+    }
+
+    rc5_add_halves(st, mark, count);
+    if (st->halves == RC5_HALVES) {
+        return rc5_finish(dec, out);
+    }
+    return false;
+}
+
+// ============ Sony SIRC (pulse-width) ============
+#define SIRC_IDLE       0
+#define SIRC_LEADER     1   // Leader mark alındı, space bekleniyor
+#define SIRC_MARK       2   // Bit mark bekleniyor
+#define SIRC_SPACE      3   // Bit sonrası space bekleniyor
+
+static bool sirc_finish(ir_decoder_t *dec, ir_frame_t *out) {
+    ir_sirc_state_t *st = &dec->sirc;
+    uint8_t bits = st->bit_count;
+    st->state = SIRC_IDLE;
+
+    if (bits != 12 && bits != 15 && bits != 20) {
+        if (bits > 0) dec->errors++;
+        return false;
+    }
+    // 7 bit command, kalan adres (5/8/13 bit); LSB ilk gelir
+    out->protocol = IR_PROTO_SIRC;
+    out->command = st->data & 0x7F;
+    out->address = (uint16_t)(st->data >> 7);
+    return true;
+}
+
+static bool sirc_feed(ir_decoder_t *dec, bool mark, uint32_t d, ir_frame_t *out) {
+    ir_sirc_state_t *st = &dec->sirc;
+
+    if (mark) {
+        if (IN_RANGE(d, IR_SIRC_LEADER_MARK_MIN, IR_SIRC_LEADER_MARK_MAX)) {
+            st->state = SIRC_LEADER;
+            st->data = 0;
+            st->bit_count = 0;
+        } else if (st->state == SIRC_MARK && st->bit_count < 20 &&
+                   (IN_RANGE(d, IR_SIRC_MARK0_MIN, IR_SIRC_MARK0_MAX) || IN_RANGE(d, IR_SIRC_MARK1_MIN, IR_SIRC_MARK1_MAX))) {
+            if (d >= IR_SIRC_MARK1_MIN) {
+                st->data |= (1UL << st->bit_count);
+            }
+            st->bit_count++;
+            st->state = SIRC_SPACE;
+        } else {
+            st->state = SIRC_IDLE;
+        }
+        return false;
+    }
+
+    if ((st->state == SIRC_LEADER || st->state == SIRC_SPACE) && IN_RANGE(d, IR_SIRC_SPACE_MIN, IR_SIRC_SPACE_MAX)) {
+        st->state = SIRC_MARK;
+        return false;
+    }
+    if (st->state == SIRC_SPACE && d >= IR_SIRC_GAP_MIN) {
+        return sirc_finish(dec, out);
+    }
+    st->state = SIRC_IDLE;
+    return false;
+}
+
+// ============ Public Functions ============
+
+void ir_decoder_reset(ir_decoder_t *dec) {
+    uint32_t errors = dec->errors;
+    *dec = (ir_decoder_t){ .errors = errors };
+}
+
+bool ir_decoder_feed(ir_decoder_t *dec, bool mark, uint32_t duration_us, ir_frame_t *out) {
+    *out = (ir_frame_t){ 0 };
+    bool done = false;
+
+    // Tüm protokoller her darbeyi görür (biri tamamlasa da diğerleri durumunu ilerletir)
+    switch (pd_feed(&dec->nec, mark, duration_us, IR_NEC_LEADER_MARK_MIN, IR_NEC_LEADER_MARK_MAX, true)) {
+        case PD_FRAME:
+            done = nec_classify(dec, dec->nec.data, out);
+            break;
+        case PD_REPEAT:
+            out->protocol = IR_PROTO_NEC;
+            out->repeat = true;
+            done = true;
+            break;
+        default:
+            break;
+    }
+    ir_frame_t other = { 0 };
+    if (pd_feed(&dec->samsung, mark, duration_us, IR_SAMSUNG_LEADER_MARK_MIN, IR_SAMSUNG_LEADER_MARK_MAX, false) == PD_FRAME &&
+        samsung_classify(dec, dec->samsung.data, &other) && !done) {
+        *out = other;
+        done = true;
+    }
+    if (rc5_feed(dec, mark, duration_us, &other) && !done) {
+        *out = other;
+        done = true;
+    }
+    if (sirc_feed(dec, mark, duration_us, &other) && !done) {
+        *out = other;
+        done = true;
+    }
+    return done;
+}
+
+bool ir_decoder_flush(ir_decoder_t *dec, ir_frame_t *out) {
+    // Sonsuz space: RC5 son yarımı ve SIRC bitişi tamamlanır, diğerleri sıfırlanır
+    bool done = ir_decoder_feed(dec, false, UINT32_MAX, out);
+    uint32_t errors = dec->errors;
+    *dec = (ir_decoder_t){ .errors = errors };
+    return done;
+}
+
+size_t ir_decoder_replay(ir_decoder_t *dec, const int32_t *pulses, size_t count,
+                         ir_frame_t *frames, size_t max_frames) {
+    size_t decoded = 0;
+    ir_frame_t frame;
+
+    ir_decoder_reset(dec);
+    for (size_t i = 0; i <= count; i++) {
+        bool done;
+        if (i == count) {
+            done = ir_decoder_flush(dec, &frame);
+        } else if (pulses[i] > 0) {
+            done = ir_decoder_feed(dec, true, (uint32_t)pulses[i], &frame);
+        } else {
+            done = ir_decoder_feed(dec, false, (uint32_t)-(int64_t)pulses[i], &frame);
+        }
+        if (done) {
+            if (decoded < max_frames) {
+                frames[decoded] = frame;
+            }
+            decoded++;
+        }
+    }
+    return decoded;
+}
+
+bool ir_decoder_busy(const ir_decoder_t *dec) {
+    return dec->nec.state != PD_IDLE || dec->samsung.state != PD_IDLE ||
+           dec->rc5.halves != 0 || dec->sirc.state != SIRC_IDLE;
+}
+
+const char *ir_decoder_protocol_name(ir_protocol_t protocol) {
+    if (protocol >= IR_PROTO_COUNT) return "?";
+    return s_protocol_names[protocol];
+}
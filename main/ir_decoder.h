@@ -0,0 +1,199 @@
+/*
+ * KlimasanAndonV2 - IR Darbe Çözücü
+ * Donanımdan bağımsız çok protokollü çözücü: backend (poll/RMT/GPIO ISR)
+ * ölçtüğü darbe sürelerini sırayla besler. Her darbe tüm protokol durum
+ * makinelerine paralel verilir; çerçeveyi tamamlayan ilk protokol kazanır.
+ *
+ * Alıcı çıkışı aktif düşük: mark = LOW (taşıyıcı var), space = HIGH.
+ */
+#ifndef IR_DECODER_H
+#define IR_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Bu kadar sessizlik = çerçeve bitti (en uzun çerçeve içi darbe: NEC 9ms mark)
+#define IR_FRAME_GAP_US         12000
+
+// ============ Zaman Pencereleri (us) ============
+// Sahada ayarlanan pencereler: kayıtlı izler ir_decoder_replay ile aynı
+// değerlerle host'ta da çözülebilir. -D ile ezilebilir.
+// NEC: leader 9ms mark + 4.5ms space (repeat: 2.25ms + 560us bitiş mark'ı),
+// bit 560us mark + 560us (0) / 1.69ms (1) space
+#ifndef IR_NEC_LEADER_MARK_MIN
+#define IR_NEC_LEADER_MARK_MIN     8000
+#endif
+#ifndef IR_NEC_LEADER_MARK_MAX
+#define IR_NEC_LEADER_MARK_MAX     10000
+#endif
+#ifndef IR_PD_LEADER_SPACE_MIN
+#define IR_PD_LEADER_SPACE_MIN     4000
+#endif
+#ifndef IR_PD_LEADER_SPACE_MAX
+#define IR_PD_LEADER_SPACE_MAX     5000
+#endif
+#ifndef IR_NEC_REPEAT_SPACE_MIN
+#define IR_NEC_REPEAT_SPACE_MIN    2000
+#endif
+#ifndef IR_NEC_REPEAT_SPACE_MAX
+#define IR_NEC_REPEAT_SPACE_MAX    2700
+#endif
+#ifndef IR_PD_BIT_MARK_MIN
+#define IR_PD_BIT_MARK_MIN         200
+#endif
+#ifndef IR_PD_BIT_MARK_MAX
+#define IR_PD_BIT_MARK_MAX         1000
+#endif
+#ifndef IR_PD_BIT_SPACE_MIN
+#define IR_PD_BIT_SPACE_MIN        400
+#endif
+#ifndef IR_PD_BIT_SPACE_SPLIT
+#define IR_PD_BIT_SPACE_SPLIT      900     // Altı 0, üstü 1
+#endif
+#ifndef IR_PD_BIT_SPACE_MAX
+#define IR_PD_BIT_SPACE_MAX        2000
+#endif
+
+// Samsung32: leader 4.5ms mark + 4.5ms space, bitler NEC ile aynı
+#ifndef IR_SAMSUNG_LEADER_MARK_MIN
+#define IR_SAMSUNG_LEADER_MARK_MIN 4000
+#endif
+#ifndef IR_SAMSUNG_LEADER_MARK_MAX
+#define IR_SAMSUNG_LEADER_MARK_MAX 5000
+#endif
+
+// RC5: yarım bit 889us; darbe 1 veya 2 yarım bit (SIRC 600/1200us ile çakışmasın)
+#ifndef IR_RC5_HALF_MIN
+#define IR_RC5_HALF_MIN            700
+#endif
+#ifndef IR_RC5_HALF_MAX
+#define IR_RC5_HALF_MAX            1100
+#endif
+#ifndef IR_RC5_FULL_MIN
+#define IR_RC5_FULL_MIN            1500
+#endif
+#ifndef IR_RC5_FULL_MAX
+#define IR_RC5_FULL_MAX            2000
+#endif
+
+// SIRC: leader 2.4ms mark, bit 600us (0) / 1.2ms (1) mark + 600us space
+#ifndef IR_SIRC_LEADER_MARK_MIN
+#define IR_SIRC_LEADER_MARK_MIN    2100
+#endif
+#ifndef IR_SIRC_LEADER_MARK_MAX
+#define IR_SIRC_LEADER_MARK_MAX    2800
+#endif
+#ifndef IR_SIRC_SPACE_MIN
+#define IR_SIRC_SPACE_MIN          400
+#endif
+#ifndef IR_SIRC_SPACE_MAX
+#define IR_SIRC_SPACE_MAX          800
+#endif
+#ifndef IR_SIRC_MARK0_MIN
+#define IR_SIRC_MARK0_MIN          400
+#endif
+#ifndef IR_SIRC_MARK0_MAX
+#define IR_SIRC_MARK0_MAX          800
+#endif
+#ifndef IR_SIRC_MARK1_MIN
+#define IR_SIRC_MARK1_MIN          1000
+#endif
+#ifndef IR_SIRC_MARK1_MAX
+#define IR_SIRC_MARK1_MAX          1400
+#endif
+#ifndef IR_SIRC_GAP_MIN
+#define IR_SIRC_GAP_MIN            2000    // Bundan uzun space: çerçeve bitti
+#endif
+
+// ============ Protokoller ============
+typedef enum {
+    IR_PROTO_NEC = 0,       // NEC (address/command checksumlı) - eski anahtar düzeni
+    IR_PROTO_NEC_EXT,       // NEC extended: 16 bit adres, sadece command checksumlı
+    IR_PROTO_SAMSUNG,       // Samsung32: 4.5ms leader, adres iki kez
+    IR_PROTO_RC5,           // Philips RC5/RC5X: Manchester, toggle biti
+    IR_PROTO_SIRC,          // Sony SIRC 12/15/20 bit
+    IR_PROTO_COUNT,
+} ir_protocol_t;
+
+// Çözülen çerçeve
+typedef struct {
+    ir_protocol_t protocol;
+    uint16_t address;
+    uint8_t command;
+    uint8_t toggle;         // RC5 toggle biti (diğerleri 0)
+    bool repeat;            // NEC repeat çerçevesi (address/command yok)
+} ir_frame_t;
+
+// ============ Protokol Durum Makineleri ============
+// NEC ve Samsung: pulse-distance (bilgi space süresinde), sadece leader farklı
+typedef struct {
+    uint32_t data;          // Toplanan bitler (MSB ilk gelen)
+    uint8_t state;
+    uint8_t bit_count;
+} ir_pd_state_t;
+
+// RC5: Manchester yarım bitleri (889us)
+typedef struct {
+    uint32_t levels;        // Yarım bit seviyeleri (bit i = i. yarım mark mı)
+    uint8_t halves;         // 0 = çerçeve dışında
+} ir_rc5_state_t;
+
+// SIRC: pulse-width (bilgi mark süresinde)
+typedef struct {
+    uint32_t data;          // LSB ilk gelen
+    uint8_t state;
+    uint8_t bit_count;
+} ir_sirc_state_t;
+
+typedef struct {
+    ir_pd_state_t nec;
+    ir_pd_state_t samsung;
+    ir_rc5_state_t rc5;
+    ir_sirc_state_t sirc;
+    uint32_t errors;        // Yapısı tamam ama checksum/format hatalı çerçeve
+} ir_decoder_t;
+
+/**
+ * @brief Tüm protokolleri sıfırla (yarım kalan çerçeveler atılır)
+ */
+void ir_decoder_reset(ir_decoder_t *dec);
+
+/**
+ * @brief Bir darbe besle
+ * @param dec Çözücü durumu
+ * @param mark true: LOW darbe (mark), false: HIGH darbe (space)
+ * @param duration_us Darbe süresi (us)
+ * @param out Çerçeve tamamlanınca doldurulur
+ * @return true: out geçerli
+ */
+bool ir_decoder_feed(ir_decoder_t *dec, bool mark, uint32_t duration_us, ir_frame_t *out);
+
+/**
+ * @brief Sessizlik bildir: son darbesi space ile bitmeyen protokolleri (RC5,
+ * SIRC) tamamla. Backend IR_FRAME_GAP_US boyunca kenar görmezse çağırır.
+ * @return true: out geçerli
+ */
+bool ir_decoder_flush(ir_decoder_t *dec, ir_frame_t *out);
+
+/**
+ * @brief Herhangi bir protokol çerçeve ortasında mı
+ */
+bool ir_decoder_busy(const ir_decoder_t *dec);
+
+/**
+ * @brief Kayıtlı darbe dizisini çöz (iz tekrar oynatma)
+ * İz formatı: >0 mark, <0 space süresi (us); IR_TRACE_LOG çıktısıyla aynı.
+ * Dizi sonunda flush yapılır. GPIO/zamanlayıcı kullanmaz, host'ta da derlenir.
+ * @param frames Çözülen çerçeveler (en fazla max_frames yazılır)
+ * @return Çözülen çerçeve sayısı (max_frames'ten büyük olabilir)
+ */
+size_t ir_decoder_replay(ir_decoder_t *dec, const int32_t *pulses, size_t count,
+                         ir_frame_t *frames, size_t max_frames);
+
+/**
+ * @brief Protokol adı (log)
+ */
+const char *ir_decoder_protocol_name(ir_protocol_t protocol);
+
+#endif // IR_DECODER_H
@@ -0,0 +1,385 @@
+/*
+ * KlimasanAndonV2 - IR Tuş Haritası
+ * Varsayılan kumandalar + NVS'den öğrenilmiş kodlar
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "esp_log.h"
+
+#include "ir_keymap.h"
+#include "nvs_storage.h"
+
+static const char *TAG = "ir_keymap";
+
+// ============ Varsayılan Kumandalar ============
+// X(address, command, action), hepsi IR_PROTO_NEC. command = IR_KEY_ANY:
+// adresin tüm komutları. Standart kumanda tuşu adres baytında taşır (komut
+// önemsiz); non-standard kumanda adres 0xFF + komut baytı gönderir.
+// Diğer protokollerin (NEC-EXT, Samsung, RC5, SIRC) kumandaları öğrenilir.
+#define IR_KEY_ANY  0x100
+
+#define IR_KEYMAP_DEFAULTS(X) \
+    /* Standart kumanda: rakamlar */ \
+    X(0xEF, IR_KEY_ANY, IR_ACTION_DIGIT_0) \
+    X(0xEE, IR_KEY_ANY, IR_ACTION_DIGIT_1) \
+    X(0xED, IR_KEY_ANY, IR_ACTION_DIGIT_2) \
+    X(0xEC, IR_KEY_ANY, IR_ACTION_DIGIT_3) \
+    X(0xEB, IR_KEY_ANY, IR_ACTION_DIGIT_4) \
+    X(0xEA, IR_KEY_ANY, IR_ACTION_DIGIT_5) \
+    X(0xE9, IR_KEY_ANY, IR_ACTION_DIGIT_6) \
+    X(0xE8, IR_KEY_ANY, IR_ACTION_DIGIT_7) \
+    X(0xE7, IR_KEY_ANY, IR_ACTION_DIGIT_8) \
+    X(0xE6, IR_KEY_ANY, IR_ACTION_DIGIT_9) \
+    /* Non-standard kumanda: rakamlar */ \
+    X(0xFF, 0x52, IR_ACTION_DIGIT_0) \
+    X(0xFF, 0x07, IR_ACTION_DIGIT_1) \
+    X(0xFF, 0x15, IR_ACTION_DIGIT_2) \
+    X(0xFF, 0x0D, IR_ACTION_DIGIT_3) \
+    X(0xFF, 0x0C, IR_ACTION_DIGIT_4) \
+    X(0xFF, 0x18, IR_ACTION_DIGIT_5) \
+    X(0xFF, 0x5E, IR_ACTION_DIGIT_6) \
+    X(0xFF, 0x08, IR_ACTION_DIGIT_7) \
+    X(0xFF, 0x1C, IR_ACTION_DIGIT_8) \
+    X(0xFF, 0x5A, IR_ACTION_DIGIT_9) \
+    /* Fonksiyon tuşları */ \
+    X(0xFF, 0x1D, IR_ACTION_POWER) \
+    X(0xFD, 0x1D, IR_ACTION_MENU) \
+    X(0xFA, 0x1D, IR_ACTION_UP) \
+    X(0xF9, 0x1D, IR_ACTION_DOWN) \
+    X(0xDA, 0x1D, IR_ACTION_WORK) \
+    X(0xDB, 0x1D, IR_ACTION_IDLE) \
+    X(0xD9, 0x1D, IR_ACTION_PLANNED) \
+    X(0xD8, 0x1D, IR_ACTION_COUNT_PLUS) \
+    X(0xFF, 0x02, IR_ACTION_MUTE) \
+    X(0xFE, IR_KEY_ANY, IR_ACTION_MUTE) \
+    X(0xFC, 0x1D, IR_ACTION_SHIFT) \
+    X(0xFF, 0xC0, IR_ACTION_RESET) \
+    X(0xC0, IR_KEY_ANY, IR_ACTION_RESET) \
+    X(0xFB, 0x1D, IR_ACTION_CLOCK_SET) \
+    X(0xFF, 0xD0, IR_ACTION_TARGET_ENTRY) \
+    X(0xD0, IR_KEY_ANY, IR_ACTION_TARGET_ENTRY) \
+    X(0xFF, 0xE0, IR_ACTION_CYCLE_ENTRY) \
+    X(0xE0, IR_KEY_ANY, IR_ACTION_CYCLE_ENTRY) \
+    X(0xFF, 0xF0, IR_ACTION_OK) \
+    X(0xF0, IR_KEY_ANY, IR_ACTION_OK)
+
+typedef struct {
+    uint16_t command;       // 0x00-0xFF veya IR_KEY_ANY
+    uint8_t address;
+    uint8_t action;
+} ir_keymap_default_t;
+
+#define IR_KEYMAP_ENTRY(addr, cmd, act) { .command = (cmd), .address = (addr), .action = (act) },
+static const ir_keymap_default_t s_defaults[] = {
+    IR_KEYMAP_DEFAULTS(IR_KEYMAP_ENTRY)
+};
+#undef IR_KEYMAP_ENTRY
+
+static const char *const s_action_names[IR_ACTION_COUNT] = {
+    [IR_ACTION_NONE]         = "NONE",
+    [IR_ACTION_DIGIT_0]      = "0",
+    [IR_ACTION_DIGIT_1]      = "1",
+    [IR_ACTION_DIGIT_2]      = "2",
+    [IR_ACTION_DIGIT_3]      = "3",
+    [IR_ACTION_DIGIT_4]      = "4",
+    [IR_ACTION_DIGIT_5]      = "5",
+    [IR_ACTION_DIGIT_6]      = "6",
+    [IR_ACTION_DIGIT_7]      = "7",
+    [IR_ACTION_DIGIT_8]      = "8",
+    [IR_ACTION_DIGIT_9]      = "9",
+    [IR_ACTION_POWER]        = "ON/OFF",
+    [IR_ACTION_MENU]         = "MENU",
+    [IR_ACTION_UP]           = "YUKARI",
+    [IR_ACTION_DOWN]         = "ASAGI",
+    [IR_ACTION_WORK]         = "YESIL",
+    [IR_ACTION_IDLE]         = "KIRMIZI",
+    [IR_ACTION_PLANNED]      = "SARI",
+    [IR_ACTION_COUNT_PLUS]   = "MAVI",
+    [IR_ACTION_MUTE]         = "MUTE",
+    [IR_ACTION_SHIFT]        = "VARDIYA",
+    [IR_ACTION_RESET]        = "RESET",
+    [IR_ACTION_CLOCK_SET]    = "SAAT",
+    [IR_ACTION_TARGET_ENTRY] = "HEDEF",
+    [IR_ACTION_CYCLE_ENTRY]  = "CYCLE",
+    [IR_ACTION_OK]           = "OK",
+};
+
+// ============ Arama Tabloları ============
+// Tam eşleşme: açık adresli hash (lineer deneme). Boyut 2'nin kuvveti ve
+// en fazla girişin ~2 katı: ortalama deneme sayısı 1-2.
+#define IR_HASH_SIZE    256
+#define IR_HASH_MASK    (IR_HASH_SIZE - 1)
+
+typedef struct {
+    uint32_t key;           // protocol << 24 | address << 8 | command
+    uint8_t action;         // IR_ACTION_NONE = boş slot
+} ir_hash_slot_t;
+
+_Static_assert(IR_HASH_SIZE >= 2 * (sizeof(s_defaults) / sizeof(s_defaults[0]) + IR_KEYMAP_LEARN_MAX),
+               "IR_HASH_SIZE too small");
+
+static ir_hash_slot_t s_hash[IR_HASH_SIZE];
+static uint8_t s_address_any[256];      // Adres joker (sadece NEC): adres → aksiyon
+
+// ============ Öğrenilmiş Kodlar (NVS blob) ============
+// v1: sadece NEC, 8 bit adres. v2: protokol + 16 bit adres.
+#define IR_KEYMAP_BLOB_VERSION  2
+
+typedef struct {
+    uint16_t address;
+    uint8_t command;
+    uint8_t action;
+    uint8_t protocol;       // ir_protocol_t
+    uint8_t reserved[3];
+} ir_learned_t;
+
+typedef struct {
+    uint8_t version;
+    uint8_t count;
+    uint8_t reserved[2];
+    ir_learned_t entries[IR_KEYMAP_LEARN_MAX];
+} ir_keymap_blob_t;
+
+typedef struct {
+    uint8_t address;
+    uint8_t command;
+    uint8_t action;
+    uint8_t reserved;
+} ir_learned_v1_t;
+
+typedef struct {
+    uint8_t version;
+    uint8_t count;
+    uint8_t reserved[2];
+    ir_learned_v1_t entries[IR_KEYMAP_LEARN_MAX];
+} ir_keymap_blob_v1_t;
+
+_Static_assert(sizeof(ir_keymap_blob_v1_t) <= sizeof(ir_keymap_blob_t), "v1 blob must fit in v2 buffer");
+
+static ir_keymap_blob_t s_learned;
+static uint8_t s_learn_action = IR_ACTION_NONE;   // NONE = öğrenme kapalı
+static uint8_t s_learn_first = 0;                 // Bu oturumda eklenen ilk giriş
+static bool s_learn_dirty = false;                // Bu oturumda bağlama yapıldı (yeni veya yeniden)
+static bool s_save_pending = false;               // Kayıt yazım bölümü dışında yapılacak
+
+// ============ Hash ============
+
+static inline uint32_t ir_key(ir_protocol_t protocol, uint16_t address, uint8_t command) {
+    return ((uint32_t)protocol << 24) | ((uint32_t)address << 8) | command;
+}
+
+static inline uint32_t ir_hash(uint32_t key) {
+    // Fibonacci hashing: üst 8 bit
+    return (key * 2654435769u) >> 24;
+}
+
+static void ir_hash_put(uint32_t key, uint8_t action) {
+    uint32_t i = ir_hash(key);
+    while (s_hash[i].action != IR_ACTION_NONE && s_hash[i].key != key) {
+        i = (i + 1) & IR_HASH_MASK;
+    }
+    s_hash[i].key = key;
+    s_hash[i].action = action;
+}
+
+static void ir_keymap_rebuild(void) {
+    memset(s_hash, 0, sizeof(s_hash));
+    memset(s_address_any, IR_ACTION_NONE, sizeof(s_address_any));
+
+    for (size_t i = 0; i < sizeof(s_defaults) / sizeof(s_defaults[0]); i++) {
+        if (s_defaults[i].command == IR_KEY_ANY) {
+            s_address_any[s_defaults[i].address] = s_defaults[i].action;
+        } else {
+            ir_hash_put(ir_key(IR_PROTO_NEC, s_defaults[i].address, (uint8_t)s_defaults[i].command),
+                        s_defaults[i].action);
+        }
+    }
+    // Öğrenilenler varsayılanları ezer (tam eşleşme jokerden önce bakılır)
+    for (int i = 0; i < s_learned.count; i++) {
+        const ir_learned_t *e = &s_learned.entries[i];
+        ir_hash_put(ir_key((ir_protocol_t)e->protocol, e->address, e->command), e->action);
+    }
+}
+
+static void ir_keymap_save(void) {
+    nvs_storage_save_ir_keymap(&s_learned, sizeof(s_learned));
+    ESP_LOGI(TAG, "Learned keymap saved (%d codes)", s_learned.count);
+}
+
+// Öğrenme controller yazım bölümünde çalışır: kayıt sadece işaretlenir
+static void ir_keymap_mark_save(void) {
+    s_save_pending = true;
+}
+
+// ============ Public Functions ============
+
+// v1 blob (sadece NEC) → v2. Aynı tamponda yerinde çevrilemez (giriş boyu büyüyor).
+static void ir_keymap_migrate_v1(void) {
+    ir_keymap_blob_v1_t old;
+    memcpy(&old, &s_learned, sizeof(old));
+    memset(&s_learned, 0, sizeof(s_learned));
+    s_learned.count = old.count;
+    for (int i = 0; i < old.count; i++) {
+        s_learned.entries[i].protocol = IR_PROTO_NEC;
+        s_learned.entries[i].address = old.entries[i].address;
+        s_learned.entries[i].command = old.entries[i].command;
+        s_learned.entries[i].action = old.entries[i].action;
+    }
+    ESP_LOGI(TAG, "Learned keymap migrated v1 -> v%d (%d codes)", IR_KEYMAP_BLOB_VERSION, old.count);
+}
+
+esp_err_t ir_keymap_init(void) {
+    memset(&s_learned, 0, sizeof(s_learned));
+    size_t len = nvs_storage_load_ir_keymap(&s_learned, sizeof(s_learned));
+    bool migrated = false;
+    if (len == sizeof(ir_keymap_blob_v1_t) && s_learned.version == 1 && s_learned.count <= IR_KEYMAP_LEARN_MAX) {
+        ir_keymap_migrate_v1();
+        migrated = true;
+    } else if (len != sizeof(s_learned) || s_learned.version != IR_KEYMAP_BLOB_VERSION ||
+               s_learned.count > IR_KEYMAP_LEARN_MAX) {
+        memset(&s_learned, 0, sizeof(s_learned));
+    }
+    s_learned.version = IR_KEYMAP_BLOB_VERSION;
+
+    // Bozuk kayıtları at
+    int valid = 0;
+    for (int i = 0; i < s_learned.count; i++) {
+        uint8_t action = s_learned.entries[i].action;
+        if (action > IR_ACTION_NONE && action < IR_ACTION_COUNT &&
+            s_learned.entries[i].protocol < IR_PROTO_COUNT) {
+            s_learned.entries[valid++] = s_learned.entries[i];
+        }
+    }
+    s_learned.count = valid;
+
+    ir_keymap_rebuild();
+    if (migrated) {
+        ir_keymap_save();
+    }
+    ESP_LOGI(TAG, "IR keymap ready (%d default, %d learned)",
+             (int)(sizeof(s_defaults) / sizeof(s_defaults[0])), s_learned.count);
+    return ESP_OK;
+}
+
+ir_action_t ir_keymap_lookup(ir_protocol_t protocol, uint16_t address, uint8_t command) {
+    uint32_t key = ir_key(protocol, address, command);
+    uint32_t i = ir_hash(key);
+    while (s_hash[i].action != IR_ACTION_NONE) {
+        if (s_hash[i].key == key) {
+            return (ir_action_t)s_hash[i].action;
+        }
+        i = (i + 1) & IR_HASH_MASK;
+    }
+    if (protocol != IR_PROTO_NEC) {
+        return IR_ACTION_NONE;
+    }
+    return (ir_action_t)s_address_any[address & 0xFF];
+}
+
+const char *ir_keymap_action_name(ir_action_t action) {
+    if (action >= IR_ACTION_COUNT) return "?";
+    return s_action_names[action];
+}
+
+// ============ Öğrenme Modu ============
+
+void ir_keymap_learn_start(void) {
+    s_learn_action = IR_ACTION_DIGIT_0;
+    s_learn_first = s_learned.count;
+    s_learn_dirty = false;
+    ESP_LOGI(TAG, "Learn mode started: press [%s]", ir_keymap_action_name(s_learn_action));
+}
+
+bool ir_keymap_is_learning(void) {
+    return s_learn_action != IR_ACTION_NONE;
+}
+
+ir_action_t ir_keymap_learn_action(void) {
+    return (ir_action_t)s_learn_action;
+}
+
+static bool ir_keymap_learn_advance(void) {
+    s_learn_action++;
+    if (s_learn_action >= IR_ACTION_COUNT) {
+        ir_keymap_learn_finish();
+        return true;
+    }
+    ESP_LOGI(TAG, "Learn: press [%s]", ir_keymap_action_name(s_learn_action));
+    return false;
+}
+
+bool ir_keymap_learn_code(ir_protocol_t protocol, uint16_t address, uint8_t command) {
+    if (!ir_keymap_is_learning()) return false;
+
+    int slot = -1;
+    for (int i = 0; i < s_learned.count; i++) {
+        const ir_learned_t *e = &s_learned.entries[i];
+        if (e->protocol == protocol && e->address == address && e->command == command) {
+            if (i >= s_learn_first) {
+                // Aynı tuşa ikinci kez basıldı: önceki aksiyona zaten bağlandı
+                ESP_LOGW(TAG, "Learn: %s 0x%04X/0x%02X already bound to [%s] in this session",
+                         ir_decoder_protocol_name(protocol), address, command,
+                         ir_keymap_action_name(e->action));
+                return false;
+            }
+            slot = i;   // Eski oturumdan: yeniden bağla
+            break;
+        }
+    }
+    if (slot < 0) {
+        if (s_learned.count >= IR_KEYMAP_LEARN_MAX) {
+            ESP_LOGE(TAG, "Learn: table full (%d), reset required", IR_KEYMAP_LEARN_MAX);
+            return false;
+        }
+        slot = s_learned.count++;
+    }
+
+    memset(&s_learned.entries[slot], 0, sizeof(s_learned.entries[slot]));
+    s_learned.entries[slot].protocol = (uint8_t)protocol;
+    s_learned.entries[slot].address = address;
+    s_learned.entries[slot].command = command;
+    s_learned.entries[slot].action = s_learn_action;
+    ir_hash_put(ir_key(protocol, address, command), s_learn_action);
+    s_learn_dirty = true;
+    ESP_LOGI(TAG, "Learn: %s 0x%04X/0x%02X -> [%s]", ir_decoder_protocol_name(protocol),
+             address, command, ir_keymap_action_name(s_learn_action));
+
+    return ir_keymap_learn_advance();
+}
+
+bool ir_keymap_learn_skip(void) {
+    if (!ir_keymap_is_learning()) return false;
+    ESP_LOGI(TAG, "Learn: [%s] skipped", ir_keymap_action_name(s_learn_action));
+    return ir_keymap_learn_advance();
+}
+
+void ir_keymap_learn_finish(void) {
+    if (!ir_keymap_is_learning()) return;
+    s_learn_action = IR_ACTION_NONE;
+    // Eski oturumdan yeniden bağlanan kod count'u artırmaz: kayıt bayrağa bakar
+    if (s_learn_dirty) {
+        ir_keymap_mark_save();
+    }
+    s_learn_dirty = false;
+    ESP_LOGI(TAG, "Learn mode finished (%d new codes)", s_learned.count - s_learn_first);
+}
+
+void ir_keymap_reset(void) {
+    s_learn_action = IR_ACTION_NONE;
+    s_learn_dirty = false;
+    s_learned.count = 0;
+    memset(s_learned.entries, 0, sizeof(s_learned.entries));
+    ir_keymap_rebuild();
+    ir_keymap_mark_save();
+    ESP_LOGI(TAG, "Learned codes cleared, default remotes only");
+}
+
+bool ir_keymap_flush(void) {
+    if (!s_save_pending) {
+        return false;
+    }
+    s_save_pending = false;
+    ir_keymap_save();
+    return true;
+}
@@ -0,0 +1,129 @@
+/*
+ * KlimasanAndonV2 - IR Tuş Haritası
+ * (protocol, address, command) üçlüsünü mantıksal aksiyona çevirir.
+ *
+ * - Varsayılan kumandalar derleme zamanında tek X-macro listesinden gelir
+ * - Öğrenilen kodlar NVS'de saklanır ve varsayılanları ezer
+ * - Arama sabit sürelidir (hash tablosu + adres joker tablosu)
+ *
+ * Tüm fonksiyonlar tek task'tan (controller) çağrılır; kilit yoktur.
+ */
+#ifndef IR_KEYMAP_H
+#define IR_KEYMAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "ir_decoder.h"
+
+// ============ Konfigürasyon ============
+#ifndef IR_KEYMAP_LEARN_MAX
+#define IR_KEYMAP_LEARN_MAX     32      // NVS'de saklanacak en fazla öğrenilmiş kod
+#endif
+
+// ============ Mantıksal Aksiyonlar ============
+// Sıra öğrenme modunun tuş sırasıdır (ekranda 1'den başlayan numara)
+typedef enum {
+    IR_ACTION_NONE = 0,
+    IR_ACTION_DIGIT_0,
+    IR_ACTION_DIGIT_1,
+    IR_ACTION_DIGIT_2,
+    IR_ACTION_DIGIT_3,
+    IR_ACTION_DIGIT_4,
+    IR_ACTION_DIGIT_5,
+    IR_ACTION_DIGIT_6,
+    IR_ACTION_DIGIT_7,
+    IR_ACTION_DIGIT_8,
+    IR_ACTION_DIGIT_9,
+    IR_ACTION_POWER,            // Ekran aç/kapa
+    IR_ACTION_MENU,             // LED menüsü
+    IR_ACTION_UP,               // Parlaklık +
+    IR_ACTION_DOWN,             // Parlaklık -
+    IR_ACTION_WORK,             // Yeşil
+    IR_ACTION_IDLE,             // Kırmızı
+    IR_ACTION_PLANNED,          // Sarı
+    IR_ACTION_COUNT_PLUS,       // Mavi - adet +1
+    IR_ACTION_MUTE,             // Alarm sustur / hedef sıfırla
+    IR_ACTION_SHIFT,            // Vardiya durdur/başlat
+    IR_ACTION_RESET,            // Ekran reset
+    IR_ACTION_CLOCK_SET,        // Saat ayarı
+    IR_ACTION_TARGET_ENTRY,     // Hedef adet giriş modu
+    IR_ACTION_CYCLE_ENTRY,      // Cycle süresi giriş modu
+    IR_ACTION_OK,               // Giriş modundan çık
+    IR_ACTION_COUNT,
+} ir_action_t;
+
+#define IR_ACTION_IS_DIGIT(a)   ((a) >= IR_ACTION_DIGIT_0 && (a) <= IR_ACTION_DIGIT_9)
+#define IR_ACTION_DIGIT(a)      ((int8_t)((a) - IR_ACTION_DIGIT_0))
+
+/**
+ * @brief Tabloyu varsayılanlardan kur ve NVS'deki öğrenilmiş kodları yükle
+ * @return ESP_OK başarılı
+ */
+esp_err_t ir_keymap_init(void);
+
+/**
+ * @brief Kodun aksiyonunu bul (O(1))
+ * @param protocol Çözülen protokol
+ * @param address IR adresi
+ * @param command IR komut baytı
+ * @return Aksiyon, tanımsızsa IR_ACTION_NONE
+ */
+ir_action_t ir_keymap_lookup(ir_protocol_t protocol, uint16_t address, uint8_t command);
+
+/**
+ * @brief Aksiyonun log adı
+ */
+const char *ir_keymap_action_name(ir_action_t action);
+
+// ============ Öğrenme Modu ============
+// Aksiyonlar sırayla sorulur; her yeni kod o anki aksiyona bağlanır.
+// Son aksiyondan sonra (veya finish ile) öğrenilenler kayda işaretlenir;
+// NVS yazımı ir_keymap_flush ile yazım bölümü dışında yapılır.
+
+/**
+ * @brief Öğrenme modunu başlat (ilk aksiyon: DIGIT_0)
+ */
+void ir_keymap_learn_start(void);
+
+/**
+ * @brief Öğrenme modu aktif mi
+ */
+bool ir_keymap_is_learning(void);
+
+/**
+ * @brief Şu an kod beklenen aksiyon
+ * @return Aksiyon, öğrenme kapalıysa IR_ACTION_NONE
+ */
+ir_action_t ir_keymap_learn_action(void);
+
+/**
+ * @brief Alınan kodu o anki aksiyona bağla ve sonraki aksiyona geç
+ * @return true: son aksiyondu, öğrenme bitti ve kayda işaretlendi
+ */
+bool ir_keymap_learn_code(ir_protocol_t protocol, uint16_t address, uint8_t command);
+
+/**
+ * @brief O anki aksiyonu atla (mevcut bağlantılar korunur)
+ * @return true: son aksiyondu, öğrenme bitti ve kayda işaretlendi
+ */
+bool ir_keymap_learn_skip(void);
+
+/**
+ * @brief Öğrenmeyi bitir, öğrenilenleri kayda işaretle
+ */
+void ir_keymap_learn_finish(void);
+
+/**
+ * @brief Öğrenilmiş tüm kodları sil (varsayılan kumandalara dön)
+ */
+void ir_keymap_reset(void);
+
+/**
+ * @brief Bekleyen öğrenilmiş kod kaydını NVS'ye yaz
+ * sys_data yazım bölümü dışında çağrılır (controller_flush_effects).
+ * @return true ise kayıt yapıldı
+ */
+bool ir_keymap_flush(void);
+
+#endif // IR_KEYMAP_H
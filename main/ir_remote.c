@@ -1,23 +1,33 @@
 /*
  * KlimasanAndonV2 - IR Remote Module
- * NEC protokolü ile IR kumanda alıcısı
+ * Çok protokollü IR kumanda alıcısı (NEC, NEC-EXT, Samsung, RC5, SIRC)
  */
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdatomic.h>
+#include <stdio.h>
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "driver/gpio.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_attr.h"
 
 #include "ir_remote.h"
+#include "ir_decoder.h"
 #include "pin_config.h"
 
+#if IR_REMOTE_BACKEND == IR_BACKEND_RMT
+#include "driver/rmt_rx.h"
+#elif IR_REMOTE_BACKEND == IR_BACKEND_GPIO_ISR
+#include "soc/gpio_struct.h"
+#endif
+
 static const char *TAG = "ir_remote";
 
 // IR decode state
-static uint32_t ir_data = 0;
-static uint8_t ir_bit_count = 0;
+static ir_decoder_t s_dec;
 
 // Input state
 static ir_input_mode_t g_input_mode = IR_INPUT_NONE;
@@ -27,44 +37,139 @@ static uint8_t g_input_digit_count = 0;
 // Callback function
 static ir_command_callback_t g_ir_callback = NULL;
 
+// İstatistik (sadece IR task yazar; overflow/glitch ISR'de)
+static volatile uint32_t s_stat_frames = 0;
+static volatile uint32_t s_stat_edges = 0;
+static volatile uint32_t s_stat_repeat_frames = 0;
+static volatile uint32_t s_stat_dropped = 0;        // Callback reddetti (kuyruk dolu)
+
+#if IR_TRACE_LOG
+// İz kaydı: son çerçevenin darbeleri (>0 mark, <0 space)
+static int32_t s_trace[IR_TRACE_MAX_PULSES];
+static uint16_t s_trace_len = 0;
+#endif
+
+// Basılı tutma durumu (son geçerli kod ve tekrar zamanlaması)
+static struct {
+    bool valid;             // Repeat çerçeveleri bu koda ait
+    ir_frame_t frame;
+    int64_t last_us;        // Son çerçeve/repeat zamanı
+    int64_t next_emit_us;   // Bir sonraki tekrar olayı
+    uint32_t interval_ms;   // Güncel tekrar aralığı
+} s_hold;
+
 // ============ Helper Functions ============
 
-static uint32_t reverse_bits_32(uint32_t value) {
-    uint32_t reversed = 0;
-    for (int i = 0; i < 32; i++) {
-        reversed = (reversed << 1) | ((value >> i) & 1);
+// Komutu callback'e ver. Uygulama callback'i sadece controller kuyruğuna yazar
+// (beklemez); komut logu da orada INFO seviyesinde basılır. Kuyruk doluysa
+// callback false döner: kaybolan komut burada sayılır.
+static void ir_emit(const ir_frame_t *frame, ir_event_type_t type) {
+    ESP_LOGD(TAG, "%s%s: Addr=0x%04X, Cmd=0x%02X", ir_decoder_protocol_name(frame->protocol),
+             type == IR_EVENT_REPEAT ? " repeat" : "", frame->address, frame->command);
+    if (g_ir_callback != NULL &&
+        !g_ir_callback(frame->protocol, frame->address, frame->command, type)) {
+        s_stat_dropped++;
     }
-    return reversed;
 }
 
-static void ir_parse_nec_code(uint32_t code) {
-    bool is_non_standard = ((code & 0xFF000000) == 0x33000000);
-    
-    code = reverse_bits_32(code);
-    
-    uint8_t address = (code >> 24) & 0xFF;
-    uint8_t address_inv = (code >> 16) & 0xFF;
-    uint8_t command = (code >> 8) & 0xFF;
-    uint8_t command_inv = code & 0xFF;
+// Basılı tutulurken tam çerçeveyi tekrar gönderen protokoller (NEC repeat kodu kullanır)
+static bool ir_is_same_held_frame(const ir_frame_t *frame, int64_t now_us) {
+    if (!s_hold.valid || now_us - s_hold.last_us > (int64_t)IR_REPEAT_TIMEOUT_MS * 1000) {
+        return false;
+    }
+    if (frame->protocol != IR_PROTO_RC5 && frame->protocol != IR_PROTO_SIRC &&
+        frame->protocol != IR_PROTO_SAMSUNG) {
+        return false;
+    }
+    // RC5: yeni basışta toggle biti değişir
+    return frame->protocol == s_hold.frame.protocol && frame->address == s_hold.frame.address &&
+           frame->command == s_hold.frame.command && frame->toggle == s_hold.frame.toggle;
+}
+
+// Son kod basılı tutuluyor: hızlanan tekrar olayı üret
+static void ir_handle_repeat(int64_t now_us) {
+    s_stat_repeat_frames++;
     
-    if (!is_non_standard && (address ^ address_inv) != 0xFF) {
-        ESP_LOGE(TAG, "Address checksum fail");
+    if (!s_hold.valid || now_us - s_hold.last_us > (int64_t)IR_REPEAT_TIMEOUT_MS * 1000) {
+        // Sahipsiz repeat (ilk çerçeve kaçtı veya tuş bırakılıp tekrar basıldı)
+        s_hold.valid = false;
+        return;
+    }
+    s_hold.last_us = now_us;
+    if (now_us < s_hold.next_emit_us) {
         return;
     }
     
-    if (!is_non_standard && (command ^ command_inv) != 0xFF) {
-        ESP_LOGE(TAG, "Command checksum fail");
+    uint32_t next = s_hold.interval_ms * IR_REPEAT_ACCEL_PCT / 100;
+    s_hold.interval_ms = (next < IR_REPEAT_MIN_MS) ? IR_REPEAT_MIN_MS : next;
+    s_hold.next_emit_us = now_us + (int64_t)s_hold.interval_ms * 1000;
+    
+    ir_emit(&s_hold.frame, IR_EVENT_REPEAT);
+}
+
+static void ir_handle_frame(const ir_frame_t *frame) {
+    int64_t now_us = esp_timer_get_time();
+    
+    if (frame->repeat || ir_is_same_held_frame(frame, now_us)) {
+        ir_handle_repeat(now_us);
         return;
     }
     
-    ESP_LOGI(TAG, "NEC: Addr=0x%02X, Cmd=0x%02X", address, command);
+    s_stat_frames++;
+    
+    // Basılı tutulursa gelecek repeat çerçeveleri bu koda aittir
+    s_hold.valid = true;
+    s_hold.frame = *frame;
+    s_hold.last_us = now_us;
+    s_hold.next_emit_us = now_us + (int64_t)IR_REPEAT_DELAY_MS * 1000;
+    s_hold.interval_ms = IR_REPEAT_INTERVAL_MS;
     
-    if (g_ir_callback != NULL) {
-        g_ir_callback(address, command);
+    ir_emit(frame, IR_EVENT_PRESS);
+}
+
+#if IR_TRACE_LOG
+static void ir_trace_dump(void) {
+    char line[128];
+    int len = 0;
+    for (uint16_t i = 0; i < s_trace_len; i++) {
+        len += snprintf(line + len, sizeof(line) - len, " %ld", (long)s_trace[i]);
+        if (len > (int)sizeof(line) - 16 || i + 1 == s_trace_len) {
+            ESP_LOGI(TAG, "IR trace:%s", line);
+            len = 0;
+        }
     }
+    s_trace_len = 0;
 }
+#endif
 
-// ============ IR Receiver Task ============
+// Backend'lerin ortak girişi: ölçülen darbeyi tüm protokollere ver
+static void ir_feed_pulse(bool mark, uint32_t duration_us) {
+    ir_frame_t frame;
+    s_stat_edges++;
+#if IR_TRACE_LOG
+    if (s_trace_len < IR_TRACE_MAX_PULSES) {
+        int32_t d = (duration_us > INT32_MAX) ? INT32_MAX : (int32_t)duration_us;
+        s_trace[s_trace_len++] = mark ? d : -d;
+    }
+#endif
+    if (ir_decoder_feed(&s_dec, mark, duration_us, &frame)) {
+        ir_handle_frame(&frame);
+    }
+}
+
+// Kenar gelmeden IR_FRAME_GAP_US geçti: space ile bitmeyen çerçeveleri tamamla
+static void ir_flush(void) {
+    ir_frame_t frame;
+    if (ir_decoder_flush(&s_dec, &frame)) {
+        ir_handle_frame(&frame);
+    }
+#if IR_TRACE_LOG
+    ir_trace_dump();
+#endif
+}
+
+#if IR_REMOTE_BACKEND == IR_BACKEND_POLL
+// ============ IR Receiver Task (busy-poll) ============
 
 static void ir_rx_task(void *pvParameters) {
     ESP_LOGI(TAG, "IR receiver task started");
@@ -72,53 +177,30 @@ static void ir_rx_task(void *pvParameters) {
     uint8_t last_ir_state = 1;
     int64_t pulse_start_us = esp_timer_get_time();
     uint32_t idle_yield_counter = 0;
+    bool flushed = true;
     
     while (1) {
         uint8_t ir_state = gpio_get_level(IR_SENSOR_PIN);
         int64_t now_us = esp_timer_get_time();
         
         if (ir_state != last_ir_state) {
-            int64_t duration_us = now_us - pulse_start_us;
-            
-            if (ir_state == 0) { // HIGH -> LOW edge (just finished a HIGH pulse)
-                // NEC: Start HIGH is 4.5ms, Bit 0 HIGH is ~560us, Bit 1 HIGH is ~1.6ms
-                if ((duration_us >= 4000 && duration_us <= 5000)) {
-                    // Start pulse detected
-                    ir_bit_count = 0;
-                    ir_data = 0;
-                } 
-                else if (ir_bit_count < 32 && duration_us >= 400 && duration_us < 2000) {
-                    if (duration_us < 900) {
-                        ir_data = (ir_data << 1) | 0;
-                    } else {
-                        ir_data = (ir_data << 1) | 1;
-                    }
-                    ir_bit_count++;
-                    
-                    if (ir_bit_count == 32) {
-                        ir_parse_nec_code(ir_data);
-                        ir_bit_count = 0;
-                        ir_data = 0;
-                    }
-                }
-            } else {
-                 // LOW -> HIGH edge
-                 // Could check for 9ms leading pulse here if needed
-            }
+            // Biten darbe: ir_state == 0 ise HIGH (space) bitti, değilse LOW (mark)
+            ir_feed_pulse(ir_state != 0, (uint32_t)(now_us - pulse_start_us));
             
             pulse_start_us = now_us;
             last_ir_state = ir_state;
             idle_yield_counter = 0;
+            flushed = false;
         } else {
             // No state change
-            // Timeout reset if in middle of packet
-            if (ir_bit_count > 0 && (now_us - pulse_start_us > 100000)) {
-                ir_bit_count = 0;
-                ir_data = 0;
+            // Çerçeve sonu sessizliği: son darbesi space ile bitmeyenleri tamamla
+            if (!flushed && (now_us - pulse_start_us > IR_FRAME_GAP_US)) {
+                ir_flush();
+                flushed = true;
             }
             
             // Cooperatively yield
-            if (ir_bit_count == 0 && ir_state == 1) {
+            if (!ir_decoder_busy(&s_dec) && ir_state == 1) {
                 // Truly idle
                 vTaskDelay(pdMS_TO_TICKS(5)); // Relax more in idle
             } else {
@@ -134,7 +216,7 @@ static void ir_rx_task(void *pvParameters) {
 
 // ============ GPIO Initialization ============
 
-static void gpio_init_ir(void) {
+static esp_err_t ir_backend_init(void) {
     gpio_config_t io_conf_ir = {
         .pin_bit_mask = (1ULL << IR_SENSOR_PIN),
         .mode = GPIO_MODE_INPUT,
@@ -142,8 +224,191 @@ static void gpio_init_ir(void) {
     };
     gpio_config(&io_conf_ir);
     ESP_LOGI(TAG, "IR GPIO initialized (Pin %d)", IR_SENSOR_PIN);
+    return ESP_OK;
+}
+
+#elif IR_REMOTE_BACKEND == IR_BACKEND_RMT
+// ============ IR Receiver Task (RMT RX) ============
+// RMT darbe sürelerini donanımda ölçer; çerçeve bitince (idle eşiği) ISR
+// callback'i task'ı uyandırır. Task çerçeveler arasında tamamen bloklu.
+
+static rmt_channel_handle_t s_rmt_chan = NULL;
+static QueueHandle_t s_rmt_done_queue = NULL;
+static rmt_symbol_word_t s_rmt_symbols[IR_RMT_MEM_SYMBOLS];
+static const rmt_receive_config_t s_rmt_rx_config = {
+    .signal_range_min_ns = IR_RMT_GLITCH_NS,
+    .signal_range_max_ns = IR_RMT_IDLE_NS,
+};
+
+static bool IRAM_ATTR ir_rmt_rx_done(rmt_channel_handle_t channel, const rmt_rx_done_event_data_t *edata, void *user_ctx) {
+    BaseType_t woken = pdFALSE;
+    xQueueSendFromISR(s_rmt_done_queue, edata, &woken);
+    return woken == pdTRUE;
 }
 
+static void ir_rx_task(void *pvParameters) {
+    ESP_LOGI(TAG, "IR receiver task started (RMT)");
+    rmt_rx_done_event_data_t done;
+    
+    rmt_receive(s_rmt_chan, s_rmt_symbols, sizeof(s_rmt_symbols), &s_rmt_rx_config);
+    while (1) {
+        xQueueReceive(s_rmt_done_queue, &done, portMAX_DELAY);
+        
+        // Her sembol iki darbe taşır; süre 0 = çerçeve sonu işareti
+        ir_decoder_reset(&s_dec);
+        for (size_t i = 0; i < done.num_symbols; i++) {
+            const rmt_symbol_word_t *sym = &done.received_symbols[i];
+            if (sym->duration0 == 0) break;
+            ir_feed_pulse(sym->level0 == 0, sym->duration0);
+            if (sym->duration1 == 0) break;
+            ir_feed_pulse(sym->level1 == 0, sym->duration1);
+        }
+        // RMT çerçeveyi idle eşiğinde bitirdi: son space hiç ölçülmez
+        ir_flush();
+        
+        // Bir sonraki çerçeve için tekrar kur (buffer işlendi)
+        rmt_receive(s_rmt_chan, s_rmt_symbols, sizeof(s_rmt_symbols), &s_rmt_rx_config);
+    }
+}
+
+static esp_err_t ir_backend_init(void) {
+    rmt_rx_channel_config_t rx_cfg = {
+        .gpio_num = IR_SENSOR_PIN,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = IR_RMT_RESOLUTION_HZ,
+        .mem_block_symbols = IR_RMT_MEM_SYMBOLS,
+    };
+    esp_err_t ret = rmt_new_rx_channel(&rx_cfg, &s_rmt_chan);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "RMT RX channel failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    s_rmt_done_queue = xQueueCreate(1, sizeof(rmt_rx_done_event_data_t));
+    rmt_rx_event_callbacks_t cbs = {
+        .on_recv_done = ir_rmt_rx_done,
+    };
+    rmt_rx_register_event_callbacks(s_rmt_chan, &cbs, NULL);
+    rmt_enable(s_rmt_chan);
+    ESP_LOGI(TAG, "IR RMT RX initialized (Pin %d, filter %d ns, idle %d us)",
+             IR_SENSOR_PIN, IR_RMT_GLITCH_NS, IR_RMT_IDLE_NS / 1000);
+    return ESP_OK;
+}
+
+#elif IR_REMOTE_BACKEND == IR_BACKEND_GPIO_ISR
+// ============ IR Receiver Task (GPIO kenar kesmesi) ============
+// ISR her kenarda biten darbeyi (seviye + süre) SPSC ring'e yazar ve task'ı
+// uyandırır. Tek üretici (ISR) head'i, tek tüketici (task) tail'i yazar.
+
+_Static_assert(IR_SENSOR_PIN < 32, "IR pini GPIO.in (0-31) aralığında olmalı");
+_Static_assert((IR_EDGE_RING_SIZE & (IR_EDGE_RING_SIZE - 1)) == 0, "IR_EDGE_RING_SIZE 2'nin kuvveti olmalı");
+
+#define IR_EDGE_MARK_BIT    ((uint32_t)1 << 31)     // Giriş: bit31 = mark
+#define IR_EDGE_DUR_MASK    (IR_EDGE_MARK_BIT - 1)  // Alt 31 bit: süre (us)
+#define IR_EDGE_RING_MASK   (IR_EDGE_RING_SIZE - 1)
+
+static DRAM_ATTR uint32_t s_edge_ring[IR_EDGE_RING_SIZE];
+static _Atomic uint32_t s_edge_head = 0;        // ISR yazar
+static _Atomic uint32_t s_edge_tail = 0;        // Task yazar
+static volatile int64_t s_edge_last_us = 0;     // Son kabul edilen kenar
+static volatile uint32_t s_stat_overflows = 0;
+static volatile uint32_t s_stat_glitches = 0;
+static TaskHandle_t s_ir_task = NULL;
+
+static void IRAM_ATTR ir_edge_isr(void *arg) {
+    int64_t now_us = esp_timer_get_time();
+    int64_t elapsed = now_us - s_edge_last_us;
+    uint32_t duration = (elapsed > IR_EDGE_DUR_MASK) ? IR_EDGE_DUR_MASK : (uint32_t)elapsed;
+    
+    if (duration < IR_EDGE_GLITCH_US) {
+        // Kısa darbe: kenarı kaydetme; tüketici aynı seviyeli darbeleri birleştirir
+        s_stat_glitches++;
+        return;
+    }
+    s_edge_last_us = now_us;
+    
+    // Yeni seviye HIGH ise biten darbe LOW (mark)
+    bool mark = (GPIO.in >> IR_SENSOR_PIN) & 1;
+    uint32_t head = atomic_load_explicit(&s_edge_head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&s_edge_tail, memory_order_acquire);
+    if (head - tail >= IR_EDGE_RING_SIZE) {
+        s_stat_overflows++;
+        return;
+    }
+    s_edge_ring[head & IR_EDGE_RING_MASK] = duration | (mark ? IR_EDGE_MARK_BIT : 0);
+    atomic_store_explicit(&s_edge_head, head + 1, memory_order_release);
+    
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_ir_task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+static void ir_rx_task(void *pvParameters) {
+    ESP_LOGI(TAG, "IR receiver task started (GPIO ISR)");
+    uint32_t pending = 0;           // Henüz beslenmemiş darbe (aynı seviye gelirse birleşir)
+    uint32_t seen_overflows = 0;
+    
+    while (1) {
+        // Bekleyen darbe varsa çerçeve sonu sessizliğini de bekle
+        TickType_t wait = (pending != 0) ? pdMS_TO_TICKS(IR_FRAME_GAP_US / 1000 + 1) : portMAX_DELAY;
+        if (ulTaskNotifyTake(pdTRUE, wait) == 0) {
+            ir_feed_pulse(pending & IR_EDGE_MARK_BIT, pending & IR_EDGE_DUR_MASK);
+            pending = 0;
+            ir_flush();
+            continue;
+        }
+        
+        if (s_stat_overflows != seen_overflows) {
+            // Kenar kaybı: çerçeve bozuk, baştan başla
+            seen_overflows = s_stat_overflows;
+            ir_decoder_reset(&s_dec);
+            pending = 0;
+        }
+        
+        uint32_t tail = atomic_load_explicit(&s_edge_tail, memory_order_relaxed);
+        uint32_t head = atomic_load_explicit(&s_edge_head, memory_order_acquire);
+        while (tail != head) {
+            uint32_t edge = s_edge_ring[tail & IR_EDGE_RING_MASK];
+            tail++;
+            if (pending != 0 && ((pending ^ edge) & IR_EDGE_MARK_BIT) == 0) {
+                // Arada glitch atlanmış: aynı seviyedeki darbeler tek darbedir
+                uint32_t merged = (pending & IR_EDGE_DUR_MASK) + (edge & IR_EDGE_DUR_MASK);
+                if (merged > IR_EDGE_DUR_MASK) merged = IR_EDGE_DUR_MASK;
+                pending = (pending & IR_EDGE_MARK_BIT) | merged;
+                continue;
+            }
+            if (pending != 0) {
+                ir_feed_pulse(pending & IR_EDGE_MARK_BIT, pending & IR_EDGE_DUR_MASK);
+            }
+            pending = edge;
+        }
+        atomic_store_explicit(&s_edge_tail, tail, memory_order_release);
+    }
+}
+
+static esp_err_t ir_backend_init(void) {
+    gpio_config_t io_conf_ir = {
+        .pin_bit_mask = (1ULL << IR_SENSOR_PIN),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .intr_type = GPIO_INTR_ANYEDGE,
+    };
+    gpio_config(&io_conf_ir);
+    s_edge_last_us = esp_timer_get_time();
+    
+    esp_err_t ret = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {  // Başka modül kurmuş olabilir
+        ESP_LOGE(TAG, "GPIO ISR service failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_LOGI(TAG, "IR GPIO edge capture initialized (Pin %d, ring %d)", IR_SENSOR_PIN, IR_EDGE_RING_SIZE);
+    return ESP_OK;
+}
+
+#else
+#error "Unknown IR_REMOTE_BACKEND"
+#endif
+
 // ============ Input Value Handling ============
 
 void ir_remote_add_digit(uint8_t digit) {
@@ -159,19 +424,39 @@ void ir_remote_add_digit(uint8_t digit) {
 // ============ Public Functions ============
 
 esp_err_t ir_remote_init(void) {
-    gpio_init_ir();
-    ir_data = 0;
-    ir_bit_count = 0;
+    ir_decoder_reset(&s_dec);
+    esp_err_t ret = ir_backend_init();
     ESP_LOGI(TAG, "IR remote initialized");
-    return ESP_OK;
+    return ret;
 }
 
 void ir_remote_start_task(void) {
     // Priority 5 (LED task 10'dur, onu ezmez), Core 1'e sabitle
+#if IR_REMOTE_BACKEND == IR_BACKEND_GPIO_ISR
+    xTaskCreatePinnedToCore(ir_rx_task, "ir_rx_task", 4096, NULL, 5, &s_ir_task, 1);
+    // Kesme task handle'ı hazır olduktan sonra açılır
+    gpio_isr_handler_add(IR_SENSOR_PIN, ir_edge_isr, NULL);
+#else
     xTaskCreatePinnedToCore(ir_rx_task, "ir_rx_task", 4096, NULL, 5, NULL, 1);
+#endif
     ESP_LOGI(TAG, "IR receiver task started (Core 1, Priority 5)");
 }
 
+void ir_remote_get_stats(ir_remote_stats_t *out) {
+    out->frames = s_stat_frames;
+    out->checksum_errors = s_dec.errors;
+    out->repeat_frames = s_stat_repeat_frames;
+    out->edges = s_stat_edges;
+    out->dropped = s_stat_dropped;
+#if IR_REMOTE_BACKEND == IR_BACKEND_GPIO_ISR
+    out->overflows = s_stat_overflows;
+    out->glitches = s_stat_glitches;
+#else
+    out->overflows = 0;
+    out->glitches = 0;
+#endif
+}
+
 void ir_remote_set_callback(ir_command_callback_t callback) {
     g_ir_callback = callback;
 }
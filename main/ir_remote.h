@@ -1,6 +1,6 @@
 /*
  * KlimasanAndonV2 - IR Remote Module
- * NEC protokolü ile IR kumanda alıcısı
+ * Çok protokollü IR kumanda alıcısı (NEC, NEC-EXT, Samsung, RC5, SIRC)
  * 
  * Fonksiyonlar:
  * - Hedef Adet Girme (rakam tuşları)
@@ -16,6 +16,72 @@
 
 #include <stdint.h>
 #include "esp_err.h"
+#include "ir_decoder.h"
+
+// ============ Alıcı Backend Seçimi ============
+#define IR_BACKEND_POLL     0   // gpio_get_level busy-poll task (task WDT kapatılır)
+#define IR_BACKEND_RMT      1   // RMT RX kanalı: donanım glitch filtresi, çerçeve sonunda task uyanır
+#define IR_BACKEND_GPIO_ISR 2   // Any-edge GPIO kesmesi + zaman damgası ring buffer
+
+#ifndef IR_REMOTE_BACKEND
+#define IR_REMOTE_BACKEND   IR_BACKEND_RMT
+#endif
+
+// RMT backend: 1 tick = 1us, glitch filtresi ve çerçeve sonu (idle) eşiği
+#define IR_RMT_RESOLUTION_HZ    1000000
+#define IR_RMT_MEM_SYMBOLS      64      // NEC çerçevesi 34 sembol
+#define IR_RMT_GLITCH_NS        1250    // Bundan kısa darbeler yok sayılır (ESP32 max ~3us)
+#define IR_RMT_IDLE_NS          12000000 // 12ms sessizlik = çerçeve bitti (start mark 9ms)
+
+// GPIO ISR backend: kenar ring buffer'ı (2'nin kuvveti) ve glitch eşiği
+#define IR_EDGE_RING_SIZE       128     // NEC çerçevesi ~68 kenar
+#define IR_EDGE_GLITCH_US       100     // Bundan kısa darbeler glitch sayılır
+
+// ============ Basılı Tutma (NEC repeat) ============
+// İlk basıştan IR_REPEAT_DELAY_MS sonra tekrar olayları başlar; aralık her
+// olayda IR_REPEAT_ACCEL_PCT oranında kısalır (en az IR_REPEAT_MIN_MS).
+#ifndef IR_REPEAT_TIMEOUT_MS
+#define IR_REPEAT_TIMEOUT_MS    200     // Bu süre repeat gelmezse tuş bırakıldı
+#endif
+#ifndef IR_REPEAT_DELAY_MS
+#define IR_REPEAT_DELAY_MS      400     // İlk tekrar olayından önceki bekleme
+#endif
+#ifndef IR_REPEAT_INTERVAL_MS
+#define IR_REPEAT_INTERVAL_MS   250     // Başlangıç tekrar aralığı
+#endif
+#ifndef IR_REPEAT_MIN_MS
+#define IR_REPEAT_MIN_MS        100     // En kısa tekrar aralığı (NEC repeat ~108ms)
+#endif
+#ifndef IR_REPEAT_ACCEL_PCT
+#define IR_REPEAT_ACCEL_PCT     80      // Her tekrarda aralık çarpanı (%)
+#endif
+
+// ============ İz Kaydı ============
+// 1: her çerçevenin darbe dizisi loglanır ("IR trace: 9000 -4500 560 ...").
+// Sahadaki kumandalardan iz toplamak içindir; ir_decoder_replay aynı formatı okur.
+#ifndef IR_TRACE_LOG
+#define IR_TRACE_LOG            0
+#endif
+#ifndef IR_TRACE_MAX_PULSES
+#define IR_TRACE_MAX_PULSES     128     // NEC 68, RC5 en fazla 28 darbe
+#endif
+
+// IR olay tipi
+typedef enum {
+    IR_EVENT_PRESS,         // Yeni tuş basışı (tam çerçeve)
+    IR_EVENT_REPEAT,        // Tuş basılı tutuluyor (otomatik tekrar)
+} ir_event_type_t;
+
+// ============ İstatistik ============
+typedef struct {
+    uint32_t frames;            // Çözülen (checksum geçen) çerçeve
+    uint32_t checksum_errors;   // Checksum/format hatalı çerçeve
+    uint32_t repeat_frames;     // Basılı tutma çerçevesi (NEC repeat veya aynı kodun tekrarı)
+    uint32_t edges;             // Yakalanan kenar/darbe
+    uint32_t overflows;         // Ring buffer dolu olduğu için düşen kenar (GPIO ISR)
+    uint32_t glitches;          // Glitch eşiğinden kısa darbe (GPIO ISR)
+    uint32_t dropped;           // Callback kabul etmedi (controller kuyruğu dolu)
+} ir_remote_stats_t;
 
 // IR giriş modları
 typedef enum {
@@ -40,10 +106,18 @@ void ir_remote_start_task(void);
 
 /**
  * @brief IR komut callback ayarla
+ * Standart NEC çerçeveleri eski anahtar düzeniyle gelir (bkz. ir_decoder.c)
+ * Callback çözücü task'ında çalışır: beklememeli (olayı kuyruğa atıp dönmeli).
+ * false dönerse komut kaybolmuştur ve stats.dropped artar.
  */
-typedef void (*ir_command_callback_t)(uint8_t address, uint8_t command);
+typedef bool (*ir_command_callback_t)(ir_protocol_t protocol, uint16_t address, uint8_t command, ir_event_type_t type);
 void ir_remote_set_callback(ir_command_callback_t callback);
 
+/**
+ * @brief Alıcı istatistiklerini al
+ */
+void ir_remote_get_stats(ir_remote_stats_t *out);
+
 /**
  * @brief IR giriş modunu al
  */
@@ -13,6 +13,7 @@
 #include <string.h>
 
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/rmt_tx.h"
@@ -20,6 +21,7 @@
 
 #include "led_strip.h"
 #include "led_strip_encoder.h"
+#include "cycle_counter.h"
 #include "pin_config.h"
 #include "system_state.h"
 #include "andon_display.h"
@@ -49,9 +51,7 @@ static rmt_encoder_handle_t g_led_encoder = NULL;
 // ============ State Variables ============
 static volatile float g_brightness = 0.3f; 
 static volatile uint32_t g_cycle_target_sec = DEFAULT_CYCLE_TARGET_SEC;
-static volatile uint32_t g_cycle_elapsed = 0;  
-static volatile uint32_t g_frame_counter = 0;   
-static volatile bool g_cycle_running = false;
+// Cycle ilerlemesi (30 frame = 1 sn) cycle_counter modülünde: atomik, host testli
 static volatile bool g_alarm_active = false;
 static volatile bool g_alarm_acknowledged = false;
 static volatile bool g_buzzer_forced_on = false; // Alarm MUTE'a kadar bekleniyor (cycle resetinden etkilenmez)
@@ -154,28 +154,25 @@ static void led_strip_task(void *arg) {
             render_cycle_bar(1.0f);
             transmit_leds();
             last_running = true;
-        } else if (g_cycle_running) {
+        } else if (cycle_counter_running()) {
             // Sadece WORK modunda sayaç ilerler
+            uint32_t cycle_frames;
             if (current_mode == MODE_WORK) {
                 last_running = true;
-                g_frame_counter++;
-                
                 // 30 FPS için 30 frame = 1 saniye
-                if (g_frame_counter >= 30) {
-                    g_cycle_elapsed++;
-                    g_frame_counter = 0;
-                }
+                cycle_frames = cycle_counter_advance();
             } else {
                 // WORK modunda değiliz, bar olduğu yerde durmalı
-                // last_running true kalır ki rendering devam etsin ama g_frame_counter artmaz
+                // last_running true kalır ki rendering devam etsin ama sayaç artmaz
                 last_running = true;
+                cycle_frames = cycle_counter_frames();
             }
             
             // Alt-saniye hassasiyeti (sub-second precision) ile ratio hesapla
             // Bu sayede 107 LED saniye atlamadan, tek tek (smooth) ilerler
             float ratio = 0.0f;
             if (g_cycle_target_sec > 0) {
-                ratio = ((float)g_cycle_elapsed + ((float)g_frame_counter / 30.0f)) / (float)g_cycle_target_sec;
+                ratio = ((float)cycle_frames / 30.0f) / (float)g_cycle_target_sec;
             }
             
             if (ratio > 1.0f && !g_alarm_acknowledged) {
@@ -232,13 +229,17 @@ static void led_strip_task(void *arg) {
             static uint8_t clock_blink_cnt = 0;
             clock_blink_cnt++;
             if (clock_blink_cnt >= 10) { // ~333ms blink rate (30fps / 10)
+                sys_data_write_begin();
                 sys_data.clock_blink_on = !sys_data.clock_blink_on;
+                sys_data_write_end();
                 clock_blink_cnt = 0;
                 // Ayar modundayken ekranı daha sık tazele ki yan-sön akıcı olsun
-                andon_display_update();
+                andon_display_invalidate(DISPLAY_DIRTY_CLOCK);
             }
-        } else {
+        } else if (!sys_data.clock_blink_on) {
+            sys_data_write_begin();
             sys_data.clock_blink_on = true;
+            sys_data_write_end();
         }
 
         vTaskDelay(pdMS_TO_TICKS(FRAME_MS));
@@ -284,9 +285,14 @@ void led_strip_set_brightness(float brightness) {
 }
 
 void led_strip_start_cycle(void) {
-    g_cycle_elapsed = 0;
-    g_frame_counter = 0;
-    g_cycle_running = true;
+    led_strip_start_cycle_at(esp_timer_get_time());
+}
+
+void led_strip_start_cycle_at(int64_t start_us) {
+    // Geçen süreyi frame cinsinden baştan say (gelecek zaman damgası = 0)
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    uint32_t frames = (elapsed_us > 0) ? (uint32_t)(elapsed_us / (FRAME_MS * 1000)) : 0;
+    cycle_counter_start(frames);
     g_alarm_active = false;
     g_alarm_acknowledged = false;  // Yeni cycle icin alarm algilama sifirla
     // g_buzzer_forced_on: dokunma — sadece MUTE (led_strip_acknowledge_alarm) temizler
@@ -313,7 +319,7 @@ void led_strip_acknowledge_alarm(void) {
 }
 
 void led_strip_clear(void) {
-    g_cycle_running = false;
+    cycle_counter_stop();
     g_menu_preview = false;
     buzzer_off();
 }
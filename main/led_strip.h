@@ -43,6 +43,13 @@ void led_strip_set_brightness(float brightness);
  */
 void led_strip_start_cycle(void);
 
+/**
+ * @brief Cycle'ı geçmişteki bir andan başlat (olay zaman damgası)
+ * Olayla işlenmesi arasındaki gecikme bar'a dahil edilir
+ * @param start_us Cycle başlangıcı (esp_timer_get_time)
+ */
+void led_strip_start_cycle_at(int64_t start_us);
+
 /**
  * @brief Cycle hedef süresini ayarla
  * @param seconds Hedef süre (saniye)
@@ -10,34 +10,38 @@
  * - Yeşil: WORK moduna geç
  * - Kırmızı: IDLE moduna geç
  * - Sarı: PLANNED moduna geç
- * - Turuncu: Adet +1 (sadece WORK modunda)
+ * - Turuncu: Adet +1 (sadece aktif WORK modunda), STANDBY'da IR öğrenme modu
+ *
+ * Girdiler (buton, IR, saniye tiki) controller kuyruğuna atılır; durum
+ * makinesi tek bir controller task'ında çalışır.
  */
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include "esp_log.h"
 #include "esp_task_wdt.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 #include "esp_timer.h"
 
 // Modüller
 #include "system_state.h"
+#include "work_mode.h"
 
 #include "andon_display.h"
 #include "led_strip.h"
 #include "rtc_ds1307.h"
+#include "time_service.h"
+#include "time_accounting.h"
 #include "ir_remote.h"
+#include "ir_keymap.h"
 #include "button_handler.h"
+#include "part_counter.h"
 #include "nvs_storage.h"
 
 static const char *TAG = "klimasan_main";
 
-// ============ Global Değişken Tanımları ============
-volatile system_data_t sys_data = {0};
-work_mode_t current_mode = MODE_STANDBY;
-shift_state_t shift_state = SHIFT_RUNNING;
-portMUX_TYPE sys_data_mux = portMUX_INITIALIZER_UNLOCKED;
-
 // ============ Duruş Süresi Yönetimi ============
 // WORK dışındaki modlarda çalışır, WORK'e geçince donar
 
@@ -49,176 +53,330 @@ static void start_durus_timer(void) {
 static void stop_durus_timer(void) {
     if (sys_data.durus_running) {
         sys_data.durus_running = false;
-        ESP_LOGI(TAG, "Duruş timer stopped: %lu sec (frozen)", (unsigned long)sys_data.durus_time);
+        time_accounting_sync();
+        ESP_LOGI(TAG, "Duruş timer stopped: %lu sec (frozen)", (unsigned long)time_accounting_get(ACCT_DURUS));
     }
 }
 
-static void update_durus_timer(void) {
-    if (sys_data.durus_running) {
-        sys_data.durus_time++;  // Basit artış, jump engeller
-    }
+// ============ Controller (Merkezi Durum Makinesi) ============
+// Buton, IR ve saniye tiki sadece olay kuyruğa atar ve döner. Tüm durum
+// değişiklikleri controller_task içinde, tek yazım bölümünde yapılır.
+// Yan etkiler (display, NVS) olay grubu bitince bir kez uygulanır.
+
+#define CONTROLLER_QUEUE_LEN    16      // Bekleyen olay kapasitesi
+#define CONTROLLER_BURST_MAX    8       // Tek yazım bölümünde işlenecek en fazla olay
+#define CONTROLLER_SAVE_TICKS   15      // Periyodik NVS kaydı (saniye)
+
+typedef enum {
+    CTRL_EVENT_BUTTON,      // Fiziksel buton
+    CTRL_EVENT_IR,          // IR kumanda komutu
+    CTRL_EVENT_TICK,        // Saniye kenarı
+    CTRL_EVENT_PARTS,       // Makine parça sayacı (PCNT toplu okuma)
+} ctrl_event_type_t;
+
+typedef struct {
+    ctrl_event_type_t type;
+    union {
+        struct {
+            button_event_t event;
+            int64_t timestamp_us;   // Basışın ilk kenarı (esp_timer)
+        } button;
+        struct {
+            ir_protocol_t protocol;
+            uint16_t address;
+            uint8_t command;
+            ir_event_type_t type;   // Basış / basılı tutma tekrarı
+        } ir;
+        struct {
+            int64_t edge_us;        // Saniye kenarı (SQW veya hesaplanan, esp_timer)
+        } tick;
+        struct {
+            uint32_t count;         // Son okumadan beri yeni parça
+            int64_t timestamp_us;   // Okuma anı (esp_timer)
+        } parts;
+    };
+} ctrl_event_t;
+
+static QueueHandle_t ctrl_queue = NULL;
+// Kuyruk doluyken kaybedilen olay (tüm tipler). Buton, IR, timer ve parça
+// task'ları iki çekirdekten yazar: atomik. IR kayıpları ayrıca ir_remote
+// istatistiğinde (stats.dropped) sayılır.
+static _Atomic uint32_t ctrl_dropped = 0;
+
+// Olay grubu boyunca biriken yan etkiler. Flash ve I2C işleri (NVS commit,
+// DS1307 yazımı) yazım bölümünde yapılmaz: burada işaretlenir, yazım bölümü
+// bittikten sonra controller_flush_effects'te uygulanır.
+#define FX_SAVE_TARGET          (1U << 0)   // Hedef adet
+#define FX_SAVE_CYCLE_TARGET    (1U << 1)   // Cycle süresi
+#define FX_SAVE_BRIGHTNESS      (1U << 2)   // LED parlaklığı
+
+static uint32_t fx_dirty = 0;           // DISPLAY_DIRTY_* maskesi
+static bool fx_persist = false;         // Acil NVS kaydı
+static bool fx_persist_periodic = false;// Throttled NVS kaydı
+static uint32_t fx_save = 0;            // FX_SAVE_* ayar kayıtları
+static bool fx_set_time = false;        // Saat ayarı RTC'ye yazılacak
+static uint8_t fx_time_hours = 0;
+static uint8_t fx_time_minutes = 0;
+
+static void ctrl_mark_dirty(uint32_t mask) {
+    fx_dirty |= mask;
 }
 
-// ============ Mode Değişim Fonksiyonları ============
+static void ctrl_mark_persist(void) {
+    fx_persist = true;
+}
 
-static void switch_to_work_mode(void) {
-    // Sayaçları aktif et (her ihtimale karşı zorla)
-    sys_data.counting_active = true;
+static void ctrl_mark_save(uint32_t mask) {
+    fx_save |= mask;
+}
 
-    if (current_mode == MODE_WORK) {
-        andon_display_update();
-        return;
+static void ctrl_request_set_time(uint8_t hours, uint8_t minutes) {
+    fx_set_time = true;
+    fx_time_hours = hours;
+    fx_time_minutes = minutes;
+}
+
+// sys_data_write_end'den sonra çağrılır: değerler bu task'ın son yazımıdır
+static void controller_flush_effects(void) {
+    if (fx_set_time) {
+        esp_err_t err = time_service_set_time(fx_time_hours, fx_time_minutes);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Saat RTC'ye yazılamadı: %s", esp_err_to_name(err));
+        }
+        fx_set_time = false;
     }
-    
-    // Duruş timer'ı durdur (frozen value)
-    stop_durus_timer();
-    
-    current_mode = MODE_WORK;
-    // Alarm aktifse bar'ı ve buzzer'ı dokunma — sadece MUTE ile susturulur
-    if (!led_strip_is_alarm_active()) {
-        led_strip_clear(); // WORK'e geçince LED barı söndür (adet gelince başlayacak)
+    if (fx_save & FX_SAVE_TARGET) {
+        nvs_storage_save_target(sys_data.target_count);
+    }
+    if (fx_save & FX_SAVE_CYCLE_TARGET) {
+        nvs_storage_save_cycle_target(led_strip_get_cycle_target());
+    }
+    if (fx_save & FX_SAVE_BRIGHTNESS) {
+        nvs_storage_save_brightness(sys_data.led_brightness_idx);
     }
-    ESP_LOGI(TAG, "🟢 MODE: WORK (Çalışma zamanı sayılıyor)");
-    nvs_storage_save_state_immediate();
-    andon_display_update();
+    fx_save = 0;
+    ir_keymap_flush();
+    if (fx_persist) {
+        nvs_storage_save_state_immediate();
+    } else if (fx_persist_periodic) {
+        nvs_storage_save_state();
+    }
+    if (fx_dirty) {
+        andon_display_invalidate(fx_dirty);
+    }
+    fx_dirty = 0;
+    fx_persist = false;
+    fx_persist_periodic = false;
 }
 
-static void switch_to_idle_mode(void) {
-    // Sayaçları aktif et
+// ============ Mod Geçişi ============
+// Geçiş tablosu ve sayma kuralları work_mode.c'de (saf mantık, host testli)
+static const char *const mode_enter_log[MODE_COUNT] = {
+    [MODE_STANDBY] = "⚪ MODE: STANDBY",
+    [MODE_WORK]    = "🟢 MODE: WORK (Çalışma zamanı sayılıyor)",
+    [MODE_IDLE]    = "🔴 MODE: IDLE (Atıl zaman sayılıyor)",
+    [MODE_PLANNED] = "🟡 MODE: PLANNED (Planlı duruş sayılıyor)",
+};
+
+// Sayma kararı için güncel durum (yazım bölümü içinde çağrılır)
+static work_mode_state_t controller_mode_state(void) {
+    return (work_mode_state_t){
+        .mode = current_mode,
+        .shift = shift_state,
+        .screen_on = sys_data.screen_on,
+        .counting_active = sys_data.counting_active,
+        .durus_running = sys_data.durus_running,
+    };
+}
+
+// Adet sadece çalışma zamanı sayarken eklenir (Turuncu, IR Mavi, makine)
+static bool controller_counts_parts(void) {
+    work_mode_state_t st = controller_mode_state();
+    return work_mode_counts_parts(&st);
+}
+
+static void controller_enter_mode(work_mode_t target) {
+    // Sayaçları aktif et (her ihtimale karşı zorla)
     sys_data.counting_active = true;
 
-    if (current_mode == MODE_IDLE) {
-        andon_display_update();
-        return;
-    }
-    
-    // Duruş timer'ı başlat (eğer daha önce WORK'te idiysek veya Standby'da isek)
-    if (current_mode == MODE_WORK || current_mode == MODE_STANDBY) {
-        sys_data.durus_time = 0;  // Yeni duruş, sıfırdan başla
+    if (current_mode != target) {
+        uint8_t act = work_mode_transition(current_mode, target);
+
+        if (act & MODE_ACT_DURUS_STOP) stop_durus_timer();
+        if (act & MODE_ACT_DURUS_RESET) time_accounting_set(ACCT_DURUS, 0);
+        if (act & MODE_ACT_DURUS_START) start_durus_timer();
+
+        current_mode = target;
+
+        // Alarm aktifse bar'ı ve buzzer'ı dokunma — sadece MUTE ile susturulur
+        if ((act & MODE_ACT_LED_CLEAR) && !led_strip_is_alarm_active()) {
+            led_strip_clear(); // WORK'e geçince LED barı söndür (adet gelince başlayacak)
+        }
+        ESP_LOGI(TAG, "%s", mode_enter_log[target]);
+        if (act & MODE_ACT_PERSIST) ctrl_mark_persist();
     }
-    start_durus_timer();
-    
-    current_mode = MODE_IDLE;
-    ESP_LOGI(TAG, "🔴 MODE: IDLE (Atıl zaman sayılıyor)");
-    nvs_storage_save_state_immediate();
-    andon_display_update();
+    time_accounting_sync();
+    ctrl_mark_dirty(DISPLAY_DIRTY_COUNTERS | DISPLAY_DIRTY_DURUS);
 }
 
-static void switch_to_planned_mode(void) {
-    // Sayaçları aktif et
-    sys_data.counting_active = true;
+// ============ IR Öğrenme: Silme Onayı ============
+// Öğrenme modunda Kırmızı tüm öğrenilmiş kodları siler: tek basış yetmez,
+// bu süre içinde ikinci bir Kırmızı basışla onaylanır.
+#ifndef IR_LEARN_RESET_CONFIRM_US
+#define IR_LEARN_RESET_CONFIRM_US   (3 * 1000000LL)
+#endif
+
+static int64_t learn_reset_armed_us = 0;   // İlk Kırmızı basış anı (0 = bekleyen onay yok)
+
+static void ir_learn_show(void);
+
+// ============ Saniye Tiki ============
+static void handle_tick(int64_t edge_us) {
+    static uint8_t save_counter = 0;
 
-    if (current_mode == MODE_PLANNED) {
-        andon_display_update();
+    // Ekran saat ve sayaçları aynı kenarda değerlendirir (render gecikmesinden bağımsız)
+    sys_data.tick_edge_us = edge_us;
+
+    if (learn_reset_armed_us != 0 && (edge_us - learn_reset_armed_us) > IR_LEARN_RESET_CONFIRM_US) {
+        learn_reset_armed_us = 0;   // Silme onayı zaman aşımı: LD4 tekrar tuş sırasını gösterir
+        ir_learn_show();
+    }
+
+    if (!time_accounting_is_running()) {
+        ctrl_mark_dirty(DISPLAY_DIRTY_CLOCK);
         return;
     }
-    
-    // Duruş timer'ı başlat (eğer daha önce WORK'te idiysek veya Standby'da isek)
-    if (current_mode == MODE_WORK || current_mode == MODE_STANDBY) {
-        sys_data.durus_time = 0;  // Yeni duruş, sıfırdan başla
+
+    // Display guncelle (saat ve sayaclar ayni anda)
+    ctrl_mark_dirty(DISPLAY_DIRTY_CLOCK | DISPLAY_DIRTY_COUNTERS | DISPLAY_DIRTY_DURUS);
+
+    // Periyodik NVS kayit (~15 saniyede bir)
+    if (++save_counter >= CONTROLLER_SAVE_TICKS) {
+        save_counter = 0;
+        fx_persist_periodic = true;
     }
-    start_durus_timer();
-    
-    current_mode = MODE_PLANNED;
-    ESP_LOGI(TAG, "🟡 MODE: PLANNED (Planlı duruş sayılıyor)");
-    nvs_storage_save_state_immediate();
-    andon_display_update();
+}
+
+static bool controller_post(const ctrl_event_t *ev) {
+    if (xQueueSend(ctrl_queue, ev, 0) != pdTRUE) {
+        uint32_t dropped = atomic_fetch_add_explicit(&ctrl_dropped, 1, memory_order_relaxed) + 1;
+        ESP_LOGW(TAG, "Controller kuyruğu dolu, olay düştü (tip=%d, toplam=%lu)",
+                 ev->type, (unsigned long)dropped);
+        return false;
+    }
+    return true;
 }
 
 // ============ Timer Task (her saniye) ============
+// Sayaçlar time_accounting'de zaman damgasıyla tutulur; bu task sadece saniye
+// kenarında controller'a kenar zamanını taşıyan tik olayı gönderir.
 static void timer_task(void *pvParameters) {
-    uint32_t last_rtc_sec = rtc_get_wall_time_seconds();
+    uint32_t last_sec = time_service_now();
+    ctrl_event_t tick = { .type = CTRL_EVENT_TICK };
+    time_service_set_tick_task(xTaskGetCurrentTaskHandle());
     
     while (1) {
-        vTaskDelay(pdMS_TO_TICKS(200));  // 200ms yoklama — RTC saniye degisimini yakala
-        
-        uint32_t now_sec = rtc_get_wall_time_seconds();
+        // DS1307 SQW kenarı varsa onunla uyan; yoksa bir sonraki saniye sınırına kadar uyu
+        uint32_t wait_ms = time_service_tick_alive() ? 1100 : time_service_ms_to_next_second() + 10;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms));
         
-        // RTC saniyesi degismemisse sadece display guncelle
-        if (now_sec == last_rtc_sec) {
-            andon_display_update();
+        uint32_t now_sec = time_service_now();
+        if (now_sec == last_sec) {
             continue;
         }
-        
-        // Kac saniye gecti? (normalde 1, ama tikanma olursa >1 olabilir)
-        uint32_t elapsed = now_sec - last_rtc_sec;
-        last_rtc_sec = now_sec;
-        
-        // Ekran kapali / sayac pasif / standby / shift durdurulmus
-        if (!sys_data.screen_on || !sys_data.counting_active || 
-            current_mode == MODE_STANDBY || shift_state == SHIFT_STOPPED) {
-            andon_display_update();
-            continue;
-        }
-        
-        // Gecen her saniye icin sayac artir
-        taskENTER_CRITICAL(&sys_data_mux);
-        for (uint32_t i = 0; i < elapsed; i++) {
-            switch (current_mode) {
-                case MODE_STANDBY:
-                    break;
-                case MODE_WORK:
-                    sys_data.work_time++;
-                    break;
-                case MODE_IDLE:
-                    sys_data.idle_time++;
-                    update_durus_timer();
-                    break;
-                case MODE_PLANNED:
-                    sys_data.planned_time++;
-                    update_durus_timer();
-                    break;
+        last_sec = now_sec;
+        tick.tick.edge_us = time_service_second_start_us(esp_timer_get_time());
+        controller_post(&tick);
+    }
+}
+
+// ============ Buton Olayı ============
+
+// IR öğrenme ekranını güncelle (menu_step 3: beklenen tuş sırası LD4'te,
+// silme onayı beklenirken LD4'te 0)
+static void ir_learn_show(void) {
+    if (ir_keymap_is_learning()) {
+        sys_data.menu_step = 3;
+        sys_data.ir_learn_step = learn_reset_armed_us != 0 ? 0 : (uint8_t)ir_keymap_learn_action();
+    } else {
+        learn_reset_armed_us = 0;
+        sys_data.menu_step = 0;
+        sys_data.ir_learn_step = 0;
+    }
+    ctrl_mark_dirty(DISPLAY_DIRTY_MENU);
+}
+
+// IR öğrenme modunda butonlar: Turuncu = tuşu atla, Yeşil = kaydet ve çık,
+// Kırmızı iki kez = öğrenilmiş kodları sil (varsayılan kumandalar)
+static void handle_learn_button(button_event_t event, int64_t timestamp_us) {
+    bool armed = learn_reset_armed_us != 0 &&
+                 (timestamp_us - learn_reset_armed_us) <= IR_LEARN_RESET_CONFIRM_US;
+    learn_reset_armed_us = 0;   // Başka tuş veya süre aşımı onayı iptal eder
+
+    switch (event) {
+        case BUTTON_EVENT_ORANGE:
+            ir_keymap_learn_skip();
+            break;
+        case BUTTON_EVENT_GREEN:
+            ir_keymap_learn_finish();
+            break;
+        case BUTTON_EVENT_RED:
+            if (armed) {
+                ir_keymap_reset();
+            } else {
+                learn_reset_armed_us = timestamp_us;
+                ESP_LOGW(TAG, "Öğrenilmiş kodlar silinecek: onay için %lld sn içinde tekrar Kırmızı",
+                         IR_LEARN_RESET_CONFIRM_US / 1000000LL);
             }
-        }
-        taskEXIT_CRITICAL(&sys_data_mux);
-        
-        // Display guncelle (saat ve sayaclar ayni anda)
-        andon_display_update();
-        
-        // Periyodik NVS kayit (~15 saniyede bir)
-        static uint8_t save_counter = 0;
-        save_counter += elapsed;
-        if (save_counter >= 15) {
-            save_counter = 0;
-            nvs_storage_save_state();
-        }
+            break;
+        default:
+            break;
     }
+    ir_learn_show();
 }
 
-// ============ Buton Callback ============
-static void on_button_event(button_event_t event) {
+static void handle_button_event(button_event_t event, int64_t timestamp_us) {
+    if (ir_keymap_is_learning()) {
+        handle_learn_button(event, timestamp_us);
+        return;
+    }
+    
     switch (event) {
         case BUTTON_EVENT_GREEN:
             // Yeşil buton: WORK moduna geç
-            switch_to_work_mode();
+            controller_enter_mode(MODE_WORK);
             break;
             
         case BUTTON_EVENT_RED:
             // Kırmızı buton: IDLE moduna geç
-            switch_to_idle_mode();
+            controller_enter_mode(MODE_IDLE);
             break;
             
         case BUTTON_EVENT_YELLOW:
             // Sarı buton: PLANNED moduna geç
-            switch_to_planned_mode();
+            controller_enter_mode(MODE_PLANNED);
             break;
             
         case BUTTON_EVENT_ORANGE:
-            // Turuncu buton: Adet +1 (sadece WORK modunda)
-            if (current_mode == MODE_WORK) {
-                taskENTER_CRITICAL(&sys_data_mux);
-                sys_data.produced_count++;
-                taskEXIT_CRITICAL(&sys_data_mux);
+            // Turuncu buton: Adet +1 (sadece aktif WORK modunda)
+            if (controller_counts_parts()) {
+                uint32_t produced = sys_produced_add(1);
                 ESP_LOGI(TAG, "🟠 Adet: %lu / %lu", 
-                         (unsigned long)sys_data.produced_count, (unsigned long)sys_data.target_count);
+                         (unsigned long)produced, (unsigned long)sys_data.target_count);
                 
-                // Cycle bar'ı başlat/sıfırla
-                led_strip_start_cycle();
+                // Cycle bar'ı basış anından başlat/sıfırla
+                led_strip_start_cycle_at(timestamp_us);
                 
-                nvs_storage_save_state_immediate();  // Kritik: Adet kaybolmasin
-                andon_display_update();
+                ctrl_mark_persist();  // Kritik: Adet kaybolmasin
+                ctrl_mark_dirty(DISPLAY_DIRTY_COUNTERS);
+            } else if (current_mode == MODE_STANDBY && sys_data.screen_on &&
+                       sys_data.menu_step == 0 && sys_data.clock_step == 0) {
+                // STANDBY'da Turuncu: IR kumanda öğrenme modu (yetkili)
+                ir_remote_set_input_mode(IR_INPUT_NONE);
+                ir_keymap_learn_start();
+                ir_learn_show();
             } else {
-                ESP_LOGW(TAG, "Turuncu buton IDLE/PLANNED modda çalışmaz");
+                ESP_LOGW(TAG, "Turuncu buton sadece aktif WORK modunda sayar");
             }
             break;
             
@@ -227,54 +385,56 @@ static void on_button_event(button_event_t event) {
     }
 }
 
-// ============ IR Komut Callback ============
-
-// Helper: Rakam tuşunu decode et
-static int8_t decode_ir_digit(uint8_t address, uint8_t command) {
-    // Standart kumanda
-    if (address != 0xFF && address != 0xFE) {
-        if (address == 0xEE) return 1;
-        if (address == 0xED) return 2;
-        if (address == 0xEC) return 3;
-        if (address == 0xEB) return 4;
-        if (address == 0xEA) return 5;
-        if (address == 0xE9) return 6;
-        if (address == 0xE8) return 7;
-        if (address == 0xE7) return 8;
-        if (address == 0xE6) return 9;
-        if (address == 0xEF) return 0;
-    }
-    // Non-standard kumanda
-    if (address == 0xFF) {
-        if (command == 0x07) return 1;
-        if (command == 0x15) return 2;
-        if (command == 0x0D) return 3;
-        if (command == 0x0C) return 4;
-        if (command == 0x18) return 5;
-        if (command == 0x5E) return 6;
-        if (command == 0x08) return 7;
-        if (command == 0x1C) return 8;
-        if (command == 0x5A) return 9;
-        if (command == 0x52) return 0;
+// ============ Parça Sayacı ============
+
+static void handle_parts(uint32_t count, int64_t timestamp_us) {
+    // Turuncu buton gibi: sadece aktif WORK modunda sayılır
+    if (!controller_counts_parts()) {
+        ESP_LOGW(TAG, "Parça sinyali aktif WORK dışında: %lu adet yok sayıldı", (unsigned long)count);
+        return;
     }
-    return -1;  // Rakam değil
+    uint32_t produced = sys_produced_add(count);
+    ESP_LOGI(TAG, "⚙️ Makine: +%lu → Adet: %lu / %lu", (unsigned long)count,
+             (unsigned long)produced, (unsigned long)sys_data.target_count);
+
+    // Cycle son okunan parçadan başlar
+    led_strip_start_cycle_at(timestamp_us);
+
+    ctrl_mark_persist();
+    ctrl_mark_dirty(DISPLAY_DIRTY_COUNTERS);
 }
 
-static void on_ir_command(uint8_t address, uint8_t command) {
-    ESP_LOGI(TAG, "IR: Addr=0x%02X, Cmd=0x%02X", address, command);
+// ============ IR Komutu ============
+
+static void handle_ir_command(ir_protocol_t protocol, uint16_t address, uint8_t command, ir_event_type_t type) {
+    bool is_repeat = (type == IR_EVENT_REPEAT);
+    ESP_LOGI(TAG, "IR: %s Addr=0x%04X, Cmd=0x%02X%s", ir_decoder_protocol_name(protocol),
+             address, command, is_repeat ? " (tekrar)" : "");
+    
+    // ========== IR ÖĞRENME ==========
+    // Öğrenme modunda her kod beklenen aksiyona bağlanır, komut işlenmez
+    if (ir_keymap_is_learning()) {
+        if (!is_repeat) {
+            ir_keymap_learn_code(protocol, address, command);
+            ir_learn_show();
+        }
+        return;
+    }
     
+    ir_action_t action = ir_keymap_lookup(protocol, address, command);
     ir_input_mode_t input_mode = ir_remote_get_input_mode();
+    bool is_digit = IR_ACTION_IS_DIGIT(action);
+
+    // Basılı tutma sadece rakam ve YUKARI/AŞAĞI'da tekrar eder (ON/OFF, RESET vb. tek sefer)
+    if (is_repeat && !is_digit && action != IR_ACTION_UP && action != IR_ACTION_DOWN) {
+        return;
+    }
 
     // ========== MENÜ/SAAT AYARI LOCKOUT ==========
     // Eğer LED Menü modundaysak, sadece LED ayar tuşlarını işle
     if (sys_data.menu_step > 0) {
-        bool allowed = false;
-        if (address == 0xFD && command == 0x1D) allowed = true; // Menu tuşu (kendi tuşu)
-        if ((address == 0xFF && command == 0x02) || (address == 0xFE)) allowed = true; // MUTE (sıfırlama)
-        if (address == 0xFA && command == 0x1D) allowed = true; // UP
-        if (address == 0xF9 && command == 0x1D) allowed = true; // DOWN
-        if (decode_ir_digit(address, command) >= 0) allowed = true; // Rakamlar
-        
+        bool allowed = is_digit || action == IR_ACTION_MENU || action == IR_ACTION_MUTE ||
+                       action == IR_ACTION_UP || action == IR_ACTION_DOWN;
         if (!allowed) {
             ESP_LOGW(TAG, "IR: LED Menü modunda bu komut engellendi (Addr:0x%02X, Cmd:0x%02X)", address, command);
             return;
@@ -282,11 +442,8 @@ static void on_ir_command(uint8_t address, uint8_t command) {
     }
     // Eğer Saat Ayarı modundaysak, sadece Saat ayar tuşlarını işle
     else if (sys_data.clock_step > 0) {
-        bool allowed = false;
-        if (address == 0xFB && command == 0x1D) allowed = true; // Saat Ayarı tuşu (kendi tuşu)
-        if (decode_ir_digit(address, command) >= 0) allowed = true; // Rakamlar
-        if ((address == 0xFF && command == 0xF0) || (address == 0xF0)) allowed = true; // OK tuşu (bazı durumlarda çıkış için)
-
+        // OK tuşu bazı durumlarda çıkış için
+        bool allowed = is_digit || action == IR_ACTION_CLOCK_SET || action == IR_ACTION_OK;
         if (!allowed) {
             ESP_LOGW(TAG, "IR: Saat Ayarı modunda bu komut engellendi (Addr:0x%02X, Cmd:0x%02X)", address, command);
             return;
@@ -294,8 +451,8 @@ static void on_ir_command(uint8_t address, uint8_t command) {
     }
     
     // Rakam girişi modunda
-    int8_t digit = decode_ir_digit(address, command);
-    if (digit >= 0 && sys_data.screen_on) {
+    if (is_digit && sys_data.screen_on) {
+        int8_t digit = IR_ACTION_DIGIT(action);
         if (input_mode == IR_INPUT_CLOCK) {
             // SAAT AYARI MODU
             if (sys_data.clock_step == 1) {
@@ -321,51 +478,59 @@ static void on_ir_command(uint8_t address, uint8_t command) {
             uint32_t val = led_strip_get_cycle_target();
             val = (val % 1000) * 10 + digit;
             led_strip_set_cycle_target(val);
-            nvs_storage_save_cycle_target(val);
+            ctrl_mark_save(FX_SAVE_CYCLE_TARGET);
             ESP_LOGI(TAG, "Cycle Target: %lu sec", (unsigned long)val);
         } else {
             // Standart: Hedef Adet'i güncelle
             uint32_t val = sys_data.target_count;
             val = (val % 1000) * 10 + digit;
             sys_data.target_count = val;
-            nvs_storage_save_target(val);
+            ctrl_mark_save(FX_SAVE_TARGET);
             ESP_LOGI(TAG, "Hedef Adet (Hızlı Giriş): %lu", (unsigned long)val);
         }
-        andon_display_update();
+        if (input_mode == IR_INPUT_CLOCK) {
+            ctrl_mark_dirty(DISPLAY_DIRTY_CLOCK);
+        } else if (input_mode == IR_INPUT_MENU_BRIGHT || input_mode == IR_INPUT_MENU_TIME ||
+                   input_mode == IR_INPUT_CYCLE_TIME) {
+            ctrl_mark_dirty(DISPLAY_DIRTY_MENU);
+        } else {
+            ctrl_mark_dirty(DISPLAY_DIRTY_TARGET);
+        }
         return;
     }
     
     // === Özel Komutlar ===
     
     // ========== EKRAN AÇ/KAPA (ON/OFF) ==========
-    // 0xFF, 0x1D → Toggle screen on/off
-    if (address == 0xFF && command == 0x1D) {
+    if (action == IR_ACTION_POWER) {
         if (sys_data.screen_on) {
             // Ekranı KAPAT
             sys_data.screen_on = false;
             sys_data.counting_active = false;
+            time_accounting_sync();
             led_strip_clear(); // Ekran kapanınca LED barı da söndür
             ESP_LOGI(TAG, "📴 EKRAN KAPANDI");
         } else {
             // Ekranı AÇ - tüm değerler sıfırlanır, hiçbir süre saymaz
             sys_data.screen_on = true;
             sys_data.counting_active = false;  // Buton basılana kadar sayma
-            sys_data.work_time = 0;
-            sys_data.idle_time = 0;
-            sys_data.planned_time = 0;
-            sys_data.produced_count = 0;
-            sys_data.durus_time = 0;
+            sys_produced_set(0);
             sys_data.durus_running = false;
             current_mode = MODE_STANDBY;
+            time_accounting_sync();
+            time_accounting_set(ACCT_WORK, 0);
+            time_accounting_set(ACCT_IDLE, 0);
+            time_accounting_set(ACCT_PLANNED, 0);
+            time_accounting_set(ACCT_DURUS, 0);
             
-            // Hedef adet NVS'den yükle
-            sys_data.target_count = nvs_storage_load_target();
+            // Hedef adet korunur: her değişiklik FX_SAVE_TARGET ile kaydedildiği için
+            // RAM'deki değer NVS'dekiyle aynı (yazım bölümünde flash okunmaz)
             
             led_strip_clear();
             ESP_LOGI(TAG, "📱 EKRAN AÇILDI - Hedef: %lu (sayaçlar beklemede)", (unsigned long)sys_data.target_count);
         }
-        nvs_storage_save_state_immediate();
-        andon_display_update();
+        ctrl_mark_persist();
+        ctrl_mark_dirty(DISPLAY_DIRTY_ALL);
         return;
     }
     
@@ -375,240 +540,299 @@ static void on_ir_command(uint8_t address, uint8_t command) {
         return;
     }
 
-    // ========== MENU TUŞU (LED AYARLARI) ==========
-    // 0xFD, 0x1D → Menu tuşu
-    if (address == 0xFD && command == 0x1D) {
-        if (sys_data.clock_step > 0) {
-            ESP_LOGW(TAG, "Saat ayarı modundayken LED Menüye girilemez");
+    switch (action) {
+        // ========== MENU TUŞU (LED AYARLARI) ==========
+        case IR_ACTION_MENU:
+            if (sys_data.clock_step > 0) {
+                ESP_LOGW(TAG, "Saat ayarı modundayken LED Menüye girilemez");
+                return;
+            }
+            if (sys_data.menu_step == 0) {
+                // Normalden -> Parlaklık Ayarına
+                sys_data.menu_step = 1;
+                ir_remote_set_input_mode(IR_INPUT_MENU_BRIGHT);
+                led_strip_set_menu_preview(true);
+                ESP_LOGI(TAG, "IR: Menu -> LED Parlaklık Ayarı");
+            } else if (sys_data.menu_step == 1) {
+                // Parlaklıktan -> Süre Ayarına
+                sys_data.menu_step = 2;
+                ir_remote_set_input_mode(IR_INPUT_MENU_TIME);
+                led_strip_set_menu_preview(true); // Preview stays true during time adjustment
+                ESP_LOGI(TAG, "IR: Menu -> LED Süre Ayarı");
+            } else {
+                // Süreden -> Çıkış ve Kaydet
+                ctrl_mark_save(FX_SAVE_BRIGHTNESS | FX_SAVE_CYCLE_TARGET);
+                sys_data.menu_step = 0;
+                ir_remote_set_input_mode(IR_INPUT_NONE);
+                led_strip_set_menu_preview(false); // Only now turn off preview
+                ESP_LOGI(TAG, "IR: Menu -> Ayarlar Kaydedildi ve Çıkıldı");
+            }
+            ctrl_mark_dirty(DISPLAY_DIRTY_MENU);
             return;
-        }
-        if (sys_data.menu_step == 0) {
-            // Normalden -> Parlaklık Ayarına
-            sys_data.menu_step = 1;
-            ir_remote_set_input_mode(IR_INPUT_MENU_BRIGHT);
-            led_strip_set_menu_preview(true);
-            ESP_LOGI(TAG, "IR: Menu -> LED Parlaklık Ayarı");
-        } else if (sys_data.menu_step == 1) {
-            // Parlaklıktan -> Süre Ayarına
-            sys_data.menu_step = 2;
-            ir_remote_set_input_mode(IR_INPUT_MENU_TIME);
-            led_strip_set_menu_preview(true); // Preview stays true during time adjustment
-            ESP_LOGI(TAG, "IR: Menu -> LED Süre Ayarı");
-        } else {
-            // Süreden -> Çıkış ve Kaydet
-            nvs_storage_save_brightness(sys_data.led_brightness_idx);
-            nvs_storage_save_cycle_target(led_strip_get_cycle_target());
-            sys_data.menu_step = 0;
-            ir_remote_set_input_mode(IR_INPUT_NONE);
-            led_strip_set_menu_preview(false); // Only now turn off preview
-            ESP_LOGI(TAG, "IR: Menu -> Ayarlar Kaydedildi ve Çıkıldı");
-        }
-        andon_display_update();
-        return;
-    }
 
-    // ========== YUKARI / AŞAĞI TUŞLARI (Parlaklık için) ==========
-    if (sys_data.menu_step == 1) {
-        if (address == 0xFA && command == 0x1D) { // YUKARI
-            if (sys_data.led_brightness_idx < 4) sys_data.led_brightness_idx++;
-            led_strip_set_brightness_idx(sys_data.led_brightness_idx);
-            ESP_LOGI(TAG, "IR: Parlaklık Artırıldı: %d", sys_data.led_brightness_idx);
-            andon_display_update();
+        // ========== YUKARI / AŞAĞI TUŞLARI (Parlaklık için) ==========
+        case IR_ACTION_UP:
+            if (sys_data.menu_step == 1) {
+                if (sys_data.led_brightness_idx < 4) sys_data.led_brightness_idx++;
+                led_strip_set_brightness_idx(sys_data.led_brightness_idx);
+                ESP_LOGI(TAG, "IR: Parlaklık Artırıldı: %d", sys_data.led_brightness_idx);
+                ctrl_mark_dirty(DISPLAY_DIRTY_MENU);
+            }
             return;
-        }
-        if (address == 0xF9 && command == 0x1D) { // AŞAĞI
-            if (sys_data.led_brightness_idx > 1) sys_data.led_brightness_idx--;
-            led_strip_set_brightness_idx(sys_data.led_brightness_idx);
-            ESP_LOGI(TAG, "IR: Parlaklık Azaltıldı: %d", sys_data.led_brightness_idx);
-            andon_display_update();
+
+        case IR_ACTION_DOWN:
+            if (sys_data.menu_step == 1) {
+                if (sys_data.led_brightness_idx > 1) sys_data.led_brightness_idx--;
+                led_strip_set_brightness_idx(sys_data.led_brightness_idx);
+                ESP_LOGI(TAG, "IR: Parlaklık Azaltıldı: %d", sys_data.led_brightness_idx);
+                ctrl_mark_dirty(DISPLAY_DIRTY_MENU);
+            }
             return;
-        }
-    }
     
-    // ========== IR BUTON → MOD DEĞİŞİMİ ==========
-    // 0xDA, 0x1D → Yeşil → WORK modu
-    if (address == 0xDA && command == 0x1D) {
-        switch_to_work_mode();
-        ESP_LOGI(TAG, "IR: Yeşil → WORK modu");
-        return;
-    }
+        // ========== IR BUTON → MOD DEĞİŞİMİ ==========
+        case IR_ACTION_WORK:
+            controller_enter_mode(MODE_WORK);
+            ESP_LOGI(TAG, "IR: Yeşil → WORK modu");
+            return;
     
-    // 0xDB, 0x1D → Kırmızı → IDLE modu
-    if (address == 0xDB && command == 0x1D) {
-        switch_to_idle_mode();
-        ESP_LOGI(TAG, "IR: Kırmızı → IDLE modu");
-        return;
-    }
+        case IR_ACTION_IDLE:
+            controller_enter_mode(MODE_IDLE);
+            ESP_LOGI(TAG, "IR: Kırmızı → IDLE modu");
+            return;
     
-    // 0xD9, 0x1D → Sarı → PLANNED modu
-    if (address == 0xD9 && command == 0x1D) {
-        switch_to_planned_mode();
-        ESP_LOGI(TAG, "IR: Sarı → PLANNED modu");
-        return;
-    }
+        case IR_ACTION_PLANNED:
+            controller_enter_mode(MODE_PLANNED);
+            ESP_LOGI(TAG, "IR: Sarı → PLANNED modu");
+            return;
     
-    // 0xD8, 0x1D → Mavi → Adet +1 (Sadece WORK modunda ve Sayaç aktifken)
-    if (address == 0xD8 && command == 0x1D) {
-        if (current_mode == MODE_WORK && sys_data.counting_active) {
-            sys_data.produced_count++;
-            ESP_LOGI(TAG, "IR: Mavi → Adet: %lu / %lu", 
-                     (unsigned long)sys_data.produced_count, (unsigned long)sys_data.target_count);
-            led_strip_start_cycle();
-            nvs_storage_save_state_immediate(); // Kritik: Adet artınca hemen kaydet
-            andon_display_update();
-        } else {
-            ESP_LOGW(TAG, "IR: Mavi buton sadece aktif WORK modunda çalışır (Timer:%d)", sys_data.counting_active);
-        }
-        return;
-    }
+        // Mavi → Adet +1 (Sadece WORK modunda ve Sayaç aktifken)
+        case IR_ACTION_COUNT_PLUS:
+            if (controller_counts_parts()) {
+                uint32_t produced = sys_produced_add(1);
+                ESP_LOGI(TAG, "IR: Mavi → Adet: %lu / %lu", 
+                         (unsigned long)produced, (unsigned long)sys_data.target_count);
+                led_strip_start_cycle();
+                ctrl_mark_persist(); // Kritik: Adet artınca hemen kaydet
+                ctrl_mark_dirty(DISPLAY_DIRTY_COUNTERS);
+            } else {
+                ESP_LOGW(TAG, "IR: Mavi buton sadece aktif WORK modunda çalışır (Timer:%d)", sys_data.counting_active);
+            }
+            return;
     
-    // ========== DİĞER KOMUTLAR ==========
+        // ========== DİĞER KOMUTLAR ==========
     
-    // Hedef Sıfırlama (0xFE address)
-    // MUTE / SIFIRLA (0xFF, 0x02 veya 0xFE adresi)
-    if ((address == 0xFF && command == 0x02) || (address == 0xFE)) {
-        // Eğer alarm aktifse SADECE sustur (sıfırlama yapma)
-        if (led_strip_is_alarm_active()) {
-            led_strip_acknowledge_alarm();
-            ESP_LOGI(TAG, "IR: MUTE -> Alarm susturuldu");
-            return;
-        }
+        // MUTE / SIFIRLA
+        case IR_ACTION_MUTE:
+            // Eğer alarm aktifse SADECE sustur (sıfırlama yapma)
+            if (led_strip_is_alarm_active()) {
+                led_strip_acknowledge_alarm();
+                ESP_LOGI(TAG, "IR: MUTE -> Alarm susturuldu");
+                return;
+            }
 
-        if (sys_data.menu_step == 2) {
-            led_strip_set_cycle_target(0);
-            ESP_LOGI(TAG, "IR: Menu -> LED Süre sıfırlandı");
-            andon_display_update();
+            if (sys_data.menu_step == 2) {
+                led_strip_set_cycle_target(0);
+                ESP_LOGI(TAG, "IR: Menu -> LED Süre sıfırlandı");
+                ctrl_mark_dirty(DISPLAY_DIRTY_MENU);
+                return;
+            }
+            sys_data.target_count = 0;
+            ctrl_mark_save(FX_SAVE_TARGET);
+            ir_remote_set_input_mode(IR_INPUT_NONE);
+            ctrl_mark_dirty(DISPLAY_DIRTY_TARGET);
+            ESP_LOGI(TAG, "IR: MUTE → Hedef sıfırlandı");
             return;
-        }
-        sys_data.target_count = 0;
-        nvs_storage_save_target(0);
-        ir_remote_set_input_mode(IR_INPUT_NONE);
-        andon_display_update();
-        ESP_LOGI(TAG, "IR: MUTE → Hedef sıfırlandı");
-        return;
-    }
-    
-
-    
-    // Vardiya Durdur/Başlat (0xFC, 0x1D)
-    if (address == 0xFC && command == 0x1D) {
-        if (shift_state == SHIFT_RUNNING) {
-            shift_state = SHIFT_STOPPED;
-            ESP_LOGI(TAG, "IR: Vardiya DURDURULDU (ekran donuk)");
-        } else {
-            shift_state = SHIFT_RUNNING;
-            ESP_LOGI(TAG, "IR: Vardiya BAŞLATILDI");
-        }
-        nvs_storage_save_state_immediate();
-        return;
-    }
     
-    // Ekran Reset
-    if ((address == 0xFF && command == 0xC0) || (address == 0xC0)) {
-        sys_data.work_time = 0;
-        sys_data.idle_time = 0;
-        sys_data.planned_time = 0;
-        sys_data.produced_count = 0;
-        sys_data.durus_time = 0;
-        sys_data.durus_running = false;
-        current_mode = MODE_IDLE;
-        led_strip_clear();
-        nvs_storage_save_state_immediate();
-        andon_display_update();
-        ESP_LOGI(TAG, "IR: Ekran RESET");
-        return;
-    }
+        // Vardiya Durdur/Başlat
+        case IR_ACTION_SHIFT:
+            if (shift_state == SHIFT_RUNNING) {
+                shift_state = SHIFT_STOPPED;
+                ESP_LOGI(TAG, "IR: Vardiya DURDURULDU (ekran donuk)");
+            } else {
+                shift_state = SHIFT_RUNNING;
+                ESP_LOGI(TAG, "IR: Vardiya BAŞLATILDI");
+            }
+            time_accounting_sync();
+            ctrl_mark_persist();
+            return;
     
-    // Saat Ayarı Modu (FKB / 0xFB, 0x1D)
-    if (address == 0xFB && command == 0x1D) {
-        if (sys_data.menu_step > 0) {
-            ESP_LOGW(TAG, "LED Menü modundayken Saat Ayarına girilemez");
+        // Ekran Reset
+        case IR_ACTION_RESET:
+            sys_produced_set(0);
+            sys_data.durus_running = false;
+            current_mode = MODE_IDLE;
+            time_accounting_sync();
+            time_accounting_set(ACCT_WORK, 0);
+            time_accounting_set(ACCT_IDLE, 0);
+            time_accounting_set(ACCT_PLANNED, 0);
+            time_accounting_set(ACCT_DURUS, 0);
+            led_strip_clear();
+            ctrl_mark_persist();
+            ctrl_mark_dirty(DISPLAY_DIRTY_COUNTERS | DISPLAY_DIRTY_DURUS);
+            ESP_LOGI(TAG, "IR: Ekran RESET");
             return;
-        }
-        if (sys_data.clock_step == 0) {
-            // Modu başlat: Saat adımına geç
-            ir_remote_set_input_mode(IR_INPUT_CLOCK);
-            sys_data.clock_step = 1;
-            
-            // Mevcut zamanı al ve yedekle
-            struct tm tm_now;
-            if (rtc_ds1307_read_tm(&tm_now) != ESP_OK) {
-                time_t now = time(NULL);
-                struct tm *tm_local = localtime(&now);
-                tm_now = *tm_local;
-            }
-            sys_data.clock_hours = tm_now.tm_hour;
-            sys_data.clock_minutes = tm_now.tm_min;
-            sys_data.clock_backup_hours = tm_now.tm_hour;
-            sys_data.clock_backup_minutes = tm_now.tm_min;
-            sys_data.clock_blink_on = true;
-            ESP_LOGI(TAG, "IR: Saat Ayarı Modu Başladı (Yedek: %02d:%02d)", sys_data.clock_backup_hours, sys_data.clock_backup_minutes);
-        } else if (sys_data.clock_step == 1) {
-            // Saat bitti, dakikaya geçmeden önce SAATİ doğrula
-            if (sys_data.clock_hours > 23) {
-                ESP_LOGW(TAG, "IR: Geçersiz SAAT (%d) -> Eski değere (%d) dönülüyor", sys_data.clock_hours, sys_data.clock_backup_hours);
-                sys_data.clock_hours = sys_data.clock_backup_hours;
+    
+        // Saat Ayarı Modu
+        case IR_ACTION_CLOCK_SET:
+            if (sys_data.menu_step > 0) {
+                ESP_LOGW(TAG, "LED Menü modundayken Saat Ayarına girilemez");
+                return;
             }
-            sys_data.clock_step = 2;
-            ESP_LOGI(TAG, "IR: Saat Ayarı (Dakika Adımı)");
-        } else {
-            // Dakika bitti, DAKİKAYI doğrula
-            if (sys_data.clock_minutes > 59) {
-                ESP_LOGW(TAG, "IR: Geçersiz DAKİKA (%d) -> Eski değere (%d) dönülüyor", sys_data.clock_minutes, sys_data.clock_backup_minutes);
-                sys_data.clock_minutes = sys_data.clock_backup_minutes;
+            if (sys_data.clock_step == 0) {
+                // Modu başlat: Saat adımına geç
+                ir_remote_set_input_mode(IR_INPUT_CLOCK);
+                sys_data.clock_step = 1;
+                
+                // Mevcut zamanı al ve yedekle
+                uint8_t hours, minutes;
+                time_service_get_hms(&hours, &minutes, NULL);
+                sys_data.clock_hours = hours;
+                sys_data.clock_minutes = minutes;
+                sys_data.clock_backup_hours = hours;
+                sys_data.clock_backup_minutes = minutes;
+                sys_data.clock_blink_on = true;
+                ESP_LOGI(TAG, "IR: Saat Ayarı Modu Başladı (Yedek: %02d:%02d)", sys_data.clock_backup_hours, sys_data.clock_backup_minutes);
+            } else if (sys_data.clock_step == 1) {
+                // Saat bitti, dakikaya geçmeden önce SAATİ doğrula
+                if (sys_data.clock_hours > 23) {
+                    ESP_LOGW(TAG, "IR: Geçersiz SAAT (%d) -> Eski değere (%d) dönülüyor", sys_data.clock_hours, sys_data.clock_backup_hours);
+                    sys_data.clock_hours = sys_data.clock_backup_hours;
+                }
+                sys_data.clock_step = 2;
+                ESP_LOGI(TAG, "IR: Saat Ayarı (Dakika Adımı)");
+            } else {
+                // Dakika bitti, DAKİKAYI doğrula
+                if (sys_data.clock_minutes > 59) {
+                    ESP_LOGW(TAG, "IR: Geçersiz DAKİKA (%d) -> Eski değere (%d) dönülüyor", sys_data.clock_minutes, sys_data.clock_backup_minutes);
+                    sys_data.clock_minutes = sys_data.clock_backup_minutes;
+                }
+                // Kaydet ve Çık
+                ctrl_request_set_time(sys_data.clock_hours, sys_data.clock_minutes);
+                sys_data.clock_step = 0;
+                ir_remote_set_input_mode(IR_INPUT_NONE);
+                ESP_LOGI(TAG, "IR: Saat Ayarı Kaydedildi ve Çıkıldı");
             }
-            // Kaydet ve Çık
-            rtc_ds1307_set_time(sys_data.clock_hours, sys_data.clock_minutes);
-            sys_data.clock_step = 0;
-            ir_remote_set_input_mode(IR_INPUT_NONE);
-            ESP_LOGI(TAG, "IR: Saat Ayarı Kaydedildi ve Çıkıldı");
-        }
-        andon_display_update();
-        return;
-    }
+            ctrl_mark_dirty(DISPLAY_DIRTY_CLOCK);
+            return;
 
-    // Hedef Adet Girme Modu (Manuel)
-    if ((address == 0xFF && command == 0xD0) || (address == 0xD0)) {
-        ir_remote_set_input_mode(IR_INPUT_TARGET);
-        ESP_LOGI(TAG, "IR: Hedef adet giriş modu");
-        return;
-    }
+        // Hedef Adet Girme Modu (Manuel)
+        case IR_ACTION_TARGET_ENTRY:
+            ir_remote_set_input_mode(IR_INPUT_TARGET);
+            ESP_LOGI(TAG, "IR: Hedef adet giriş modu");
+            return;
     
-    // Cycle Süresi Girme Modu
-    if ((address == 0xFF && command == 0xE0) || (address == 0xE0)) {
-        ir_remote_set_input_mode(IR_INPUT_CYCLE_TIME);
-        ESP_LOGI(TAG, "IR: Cycle süresi giriş modu");
-        return;
-    }
+        // Cycle Süresi Girme Modu
+        case IR_ACTION_CYCLE_ENTRY:
+            ir_remote_set_input_mode(IR_INPUT_CYCLE_TIME);
+            ESP_LOGI(TAG, "IR: Cycle süresi giriş modu");
+            return;
     
-    // Giriş modundan çık (OK tuşu)
-    if ((address == 0xFF && command == 0xF0) || (address == 0xF0)) {
-        if (sys_data.clock_step > 0) {
-            // Saat ayarındaysak OK'e basınca bir sonraki adıma geçer veya kaydeder
-            if (sys_data.clock_step == 1) {
-                sys_data.clock_step = 2;
+        // Giriş modundan çık (OK tuşu)
+        case IR_ACTION_OK:
+            if (sys_data.clock_step > 0) {
+                // Saat ayarındaysak OK'e basınca bir sonraki adıma geçer veya kaydeder
+                if (sys_data.clock_step == 1) {
+                    sys_data.clock_step = 2;
+                } else {
+                    ctrl_request_set_time(sys_data.clock_hours, sys_data.clock_minutes);
+                    sys_data.clock_step = 0;
+                    ir_remote_set_input_mode(IR_INPUT_NONE);
+                }
             } else {
-                rtc_ds1307_set_time(sys_data.clock_hours, sys_data.clock_minutes);
-                sys_data.clock_step = 0;
                 ir_remote_set_input_mode(IR_INPUT_NONE);
             }
-        } else {
-            ir_remote_set_input_mode(IR_INPUT_NONE);
-        }
-        andon_display_update();
-        ESP_LOGI(TAG, "IR: Giriş/Ayar modu kapatıldı");
-        return;
+            ctrl_mark_dirty(DISPLAY_DIRTY_CLOCK);
+            ESP_LOGI(TAG, "IR: Giriş/Ayar modu kapatıldı");
+            return;
+
+        default:
+            return;
+    }
+}
+
+// ============ Controller Task ============
+static void controller_dispatch(const ctrl_event_t *ev) {
+    switch (ev->type) {
+        case CTRL_EVENT_BUTTON:
+            handle_button_event(ev->button.event, ev->button.timestamp_us);
+            break;
+        case CTRL_EVENT_IR:
+            handle_ir_command(ev->ir.protocol, ev->ir.address, ev->ir.command, ev->ir.type);
+            break;
+        case CTRL_EVENT_TICK:
+            handle_tick(ev->tick.edge_us);
+            break;
+        case CTRL_EVENT_PARTS:
+            handle_parts(ev->parts.count, ev->parts.timestamp_us);
+            break;
+        default:
+            break;
+    }
+}
+
+// Kuyrukta biriken olaylar tek yazım bölümünde işlenir: okuyucular (display,
+// NVS) olay grubunun ya öncesini ya sonrasını görür, yarısını değil.
+static void controller_task(void *pvParameters) {
+    ctrl_event_t ev;
+    
+    while (1) {
+        xQueueReceive(ctrl_queue, &ev, portMAX_DELAY);
+        
+        sys_data_write_begin();
+        int processed = 0;
+        do {
+            controller_dispatch(&ev);
+        } while (++processed < CONTROLLER_BURST_MAX &&
+                 xQueueReceive(ctrl_queue, &ev, 0) == pdTRUE);
+        sys_data_write_end();
+        
+        controller_flush_effects();
     }
 }
 
+// ============ Callback Girişleri ============
+// Üretici bağlamında (buton/IR task) iş yapılmaz: olay kuyruğa atılır ve dönülür.
+static void on_button_event(button_event_t event, int64_t timestamp_us) {
+    ctrl_event_t ev = { .type = CTRL_EVENT_BUTTON, .button = { .event = event, .timestamp_us = timestamp_us } };
+    controller_post(&ev);
+}
+
+static void on_part_count(uint32_t count, int64_t timestamp_us) {
+    ctrl_event_t ev = { .type = CTRL_EVENT_PARTS, .parts = { .count = count, .timestamp_us = timestamp_us } };
+    controller_post(&ev);
+}
+
+// false: kuyruk dolu, ir_remote kaybı stats.dropped'a yazar
+static bool on_ir_command(ir_protocol_t protocol, uint16_t address, uint8_t command, ir_event_type_t type) {
+    ctrl_event_t ev = { .type = CTRL_EVENT_IR,
+                        .ir = { .protocol = protocol, .address = address, .command = command, .type = type } };
+    return controller_post(&ev);
+}
+
 // ============ Power-on Recovery ============
-static void power_on_recovery(void) {
-    system_state_backup_t last = nvs_storage_load_state();
+// Flash'tan okunan açılış değerleri: yazım bölümü açılmadan önce toplanır
+typedef struct {
+    system_state_backup_t last;
+    uint32_t target;
+    uint32_t cycle_target;
+    uint8_t brightness;
+} power_on_nvs_t;
+
+static void power_on_load(power_on_nvs_t *nvs) {
+    nvs->last = nvs_storage_load_state();
+    nvs->target = nvs_storage_load_target();
+    nvs->cycle_target = nvs_storage_load_cycle_target();
+    nvs->brightness = nvs_storage_load_brightness();
+}
+
+// sys_data yazım bölümü içinde çağrılır: sadece RAM'e uygular
+static void power_on_recovery(const power_on_nvs_t *nvs) {
+    const system_state_backup_t last = nvs->last;
     
     // Varsayılan değerler
-    sys_data.target_count = nvs_storage_load_target();
-    led_strip_set_cycle_target(nvs_storage_load_cycle_target());
-    sys_data.led_brightness_idx = nvs_storage_load_brightness();
+    sys_data.target_count = nvs->target;
+    led_strip_set_cycle_target(nvs->cycle_target);
+    sys_data.led_brightness_idx = nvs->brightness;
     led_strip_set_brightness_idx(sys_data.led_brightness_idx);
     sys_data.menu_step = 0;
     
@@ -616,34 +840,34 @@ static void power_on_recovery(void) {
         // Vardiya durdurulmuş olarak kalmıştı — kaydedilen modda devam et
         shift_state = SHIFT_STOPPED;
         current_mode = (work_mode_t)last.work_mode;
-        sys_data.work_time = last.work_t;
-        sys_data.idle_time = last.idle_t;
-        sys_data.planned_time = last.planned_t;
-        sys_data.produced_count = last.prod_cnt;
-        sys_data.durus_time = last.durus_t;
+        time_accounting_set(ACCT_WORK, last.work_t);
+        time_accounting_set(ACCT_IDLE, last.idle_t);
+        time_accounting_set(ACCT_PLANNED, last.planned_t);
+        sys_produced_set(last.prod_cnt);
+        time_accounting_set(ACCT_DURUS, last.durus_t);
         sys_data.counting_active = false;  // Vardiya durmuştu, sayaç pasif
         ESP_LOGI(TAG, "🔄 RECOVERY: Shift STOPPED, mode=%d, ekran donuk", current_mode);
         
     } else if (last.valid && (last.work_mode == MODE_IDLE || last.work_mode == MODE_PLANNED)) {
         // IDLE veya PLANNED modunda güç kesilmişti
         current_mode = (work_mode_t)last.work_mode;
-        sys_data.work_time = last.work_t;
-        sys_data.idle_time = last.idle_t;
-        sys_data.planned_time = last.planned_t;
-        sys_data.produced_count = last.prod_cnt;
-        sys_data.durus_time = last.durus_t; // DURUS RESTORE
+        time_accounting_set(ACCT_WORK, last.work_t);
+        time_accounting_set(ACCT_IDLE, last.idle_t);
+        time_accounting_set(ACCT_PLANNED, last.planned_t);
+        sys_produced_set(last.prod_cnt);
+        time_accounting_set(ACCT_DURUS, last.durus_t); // DURUS RESTORE
         
         // Offline süresini ilgili sayaca ekle
-        uint32_t now = rtc_get_wall_time_seconds();
+        uint32_t now = time_service_now();
         if (last.last_upd > 0 && now > last.last_upd) {
             uint32_t offline = now - last.last_upd;
             if (offline < 86400) {
                 if (current_mode == MODE_IDLE) {
-                    sys_data.idle_time += offline;
+                    time_accounting_add(ACCT_IDLE, offline);
                 } else {
-                    sys_data.planned_time += offline;
+                    time_accounting_add(ACCT_PLANNED, offline);
                 }
-                sys_data.durus_time += offline; // Offline süresini mevcut duruşa da ekle
+                time_accounting_add(ACCT_DURUS, offline); // Offline süresini mevcut duruşa da ekle
                 ESP_LOGI(TAG, "⏱️ Offline: %lu sec added to mode %d and durus_time", (unsigned long)offline, current_mode);
             }
         }
@@ -658,33 +882,33 @@ static void power_on_recovery(void) {
         // WORK modunda guc kesilmisti - kaldigi yerden devam et
         shift_state = SHIFT_RUNNING;
         current_mode = MODE_WORK;
-        sys_data.work_time = last.work_t;
-        sys_data.idle_time = last.idle_t;
-        sys_data.planned_time = last.planned_t;
-        sys_data.produced_count = last.prod_cnt;
-        sys_data.durus_time = last.durus_t;
+        time_accounting_set(ACCT_WORK, last.work_t);
+        time_accounting_set(ACCT_IDLE, last.idle_t);
+        time_accounting_set(ACCT_PLANNED, last.planned_t);
+        sys_produced_set(last.prod_cnt);
+        time_accounting_set(ACCT_DURUS, last.durus_t);
 
         // Offline sureyi work_time'a ekle
-        uint32_t now_w = rtc_get_wall_time_seconds();
+        uint32_t now_w = time_service_now();
         if (last.last_upd > 0 && now_w > last.last_upd) {
             uint32_t offline = now_w - last.last_upd;
             if (offline < 86400) {  // Max 24 saat
-                sys_data.work_time += offline;
+                time_accounting_add(ACCT_WORK, offline);
                 ESP_LOGI(TAG, "Offline: %lu sec -> work_time += %lu", (unsigned long)offline, (unsigned long)offline);
             }
         }
         sys_data.counting_active = true;
         ESP_LOGI(TAG, "RECOVERY: MODE_WORK continues (Work:%lu, Prod:%lu)",
-                 (unsigned long)sys_data.work_time, (unsigned long)sys_data.produced_count);
+                 (unsigned long)time_accounting_get(ACCT_WORK), (unsigned long)sys_produced_get());
 
     } else {
         // Yeni başlangıç veya geçersiz veri -> STANDBY'da bekle
         current_mode = MODE_STANDBY;
         shift_state = SHIFT_RUNNING;
-        sys_data.work_time = 0;
-        sys_data.idle_time = 0;
-        sys_data.planned_time = 0;
-        sys_data.produced_count = 0;
+        time_accounting_set(ACCT_WORK, 0);
+        time_accounting_set(ACCT_IDLE, 0);
+        time_accounting_set(ACCT_PLANNED, 0);
+        sys_produced_set(0);
         sys_data.counting_active = false; // Kullanıcı butona basana kadar bekle
         ESP_LOGI(TAG, "Fresh start (NVS invalid or empty) - MODE_STANDBY");
     }
@@ -692,7 +916,8 @@ static void power_on_recovery(void) {
     // Ekran varsayılan olarak AÇIK
     sys_data.screen_on = true;
     sys_data.menu_step = 0;
-    andon_display_update();
+    time_accounting_sync();
+    andon_display_invalidate(DISPLAY_DIRTY_ALL);
 }
 
 // ============ Main Entry Point ============
@@ -701,39 +926,57 @@ void app_main(void) {
     ESP_LOGI(TAG, "  KlimasanAndonV2 Starting...");
     ESP_LOGI(TAG, "========================================");
     
+    // 0. Paylaşılan durum (seqlock)
+    system_state_init();
+    
     // 1. NVS başlat
     nvs_storage_init();
     
-    // 2. RTC başlat (I2C)
+    // 2. RTC başlat (I2C) ve saati önbelleğe al
     rtc_ds1307_init();
+    time_service_init();
     
-    // 3. IR task için watchdog'u disable et
+    // 3. Busy-poll IR task'ı idle task'ı aç bırakır: sadece o backend'de watchdog kapalı
+#if IR_REMOTE_BACKEND == IR_BACKEND_POLL
     esp_task_wdt_deinit();
+#endif
     
-    // 4. Power-on recovery
-    power_on_recovery();
+    // 4. Power-on recovery (NVS okumaları seqlock tek sayıyken yapılmaz)
+    power_on_nvs_t boot_nvs;
+    power_on_load(&boot_nvs);
+    sys_data_write_begin();
+    power_on_recovery(&boot_nvs);
+    sys_data_write_end();
     
     // 5. Modülleri başlat
     andon_display_init();
     led_strip_init();
     ir_remote_init();
+    ir_keymap_init();
     button_handler_init();
+    part_counter_init();
     
-    // 6. Callback'leri ayarla
+    // 6. Controller kuyruğu ve callback'leri ayarla
+    ctrl_queue = xQueueCreate(CONTROLLER_QUEUE_LEN, sizeof(ctrl_event_t));
     button_handler_set_callback(on_button_event);
     ir_remote_set_callback(on_ir_command);
+    part_counter_set_callback(on_part_count);
     
     // 7. İlk display güncellemesi
-    andon_display_update();
+    andon_display_invalidate(DISPLAY_DIRTY_ALL);
     
     // 8. Task'ları başlat
     andon_display_start_task();  // Core 0, Priority 5 (DISPLAY HER ŞEYDEN ÖNCE GELİR)
     
     led_strip_start_task();      // Core 1, Priority 5 (LED BAR real-time olmalı)
-    ir_remote_start_task();      // Core 1, Priority 4 (LED'in bir tık altında)
-    button_handler_start_task(); // Core 1, Priority 3
+    ir_remote_start_task();      // Core 1, Priority 5 (callback controller kuyruğuna yazar)
+    button_handler_start_task(); // Core 1, Priority 6 (olay gelene kadar uyur)
+    part_counter_start_task();   // Core 1, Priority 3 (PART_COUNTER_PIN >= 0 ise)
     nvs_storage_start_task();    // Core 1, Priority 1
     
+    // Controller task (Core 1, Priority 4 - girdileri işleyen tek yazıcı)
+    xTaskCreatePinnedToCore(controller_task, "controller_task", 4096, NULL, 4, NULL, 1);
+    
     // Timer task (Core 0, Priority 4 - Display ile aynı çekirdek ama altında)
     xTaskCreatePinnedToCore(timer_task, "timer_task", 4096, NULL, 4, NULL, 0);
     
@@ -3,7 +3,9 @@
  * Non-Volatile Storage işlemleri
  */
 #include <stdint.h>
+#include <string.h>
 #include "esp_log.h"
+#include "esp_rom_crc.h"
 #include "nvs_flash.h"
 #include "nvs.h"
 #include "freertos/FreeRTOS.h"
@@ -11,7 +13,8 @@
 #include "freertos/queue.h"
 
 #include "nvs_storage.h"
-#include "rtc_ds1307.h"
+#include "time_service.h"
+#include "time_accounting.h"
 #include "system_state.h"
 #include "led_strip.h"
 
@@ -24,6 +27,122 @@ static QueueHandle_t nvs_save_queue = NULL;
 #define NVS_SAVE_THROTTLED  0   // Normal kayit, throttle uygulanir
 #define NVS_SAVE_URGENT     1   // Acil kayit, throttle atlanir
 
+// ============ Durum Kaydı (tek blob) ============
+// Tüm durum tek blob + tek commit. İki slot sırayla yazılır (seq çift: A,
+// tek: B); yüklemede CRC'si geçen en yüksek seq alınır. Yarım kalan veya
+// bozulan yazım bir önceki kayda düşer.
+#define NVS_STATE_VERSION   1
+#define NVS_STATE_KEY_A     "state_a"
+#define NVS_STATE_KEY_B     "state_b"
+
+typedef struct {
+    uint8_t version;
+    uint8_t work_mode;
+    uint8_t shift_state;
+    uint8_t reserved;
+    uint32_t seq;               // Her kayıtta +1
+    uint32_t work_t;
+    uint32_t idle_t;
+    uint32_t planned_t;
+    uint32_t durus_t;
+    uint32_t prod_cnt;
+    uint32_t target_cnt;
+    uint32_t cycle_target;
+    uint32_t last_upd;          // Epoch (offline süresi hesabı)
+    uint32_t crc;               // Önceki alanların CRC32'si
+} nvs_state_record_t;
+
+// Son yazılan/yüklenen kayıt (aynı içerik tekrar yazılmaz)
+static nvs_state_record_t s_last_record;
+static bool s_last_valid = false;
+static bool s_legacy_keys = false;      // Eski anahtarlı kayıt var: ilk blob'da silinir
+
+// Eski format (anahtar başına bir değer); target_cnt/cycle_target ayarlar için kalır
+static const char *const s_legacy_state_keys[] = {
+    "valid", "work_mode", "shift_state", "work_time", "idle_time",
+    "planned_time", "produced_cnt", "durus_time", "last_update",
+};
+
+static uint32_t nvs_state_crc(const nvs_state_record_t *rec) {
+    return esp_rom_crc32_le(0, (const uint8_t *)rec, offsetof(nvs_state_record_t, crc));
+}
+
+// seq, last_upd ve crc hariç aynı mı (sayaçlar duruyorsa yazmaya gerek yok)
+static bool nvs_state_same_content(const nvs_state_record_t *a, const nvs_state_record_t *b) {
+    return a->work_mode == b->work_mode && a->shift_state == b->shift_state &&
+           a->work_t == b->work_t && a->idle_t == b->idle_t &&
+           a->planned_t == b->planned_t && a->durus_t == b->durus_t &&
+           a->prod_cnt == b->prod_cnt && a->target_cnt == b->target_cnt &&
+           a->cycle_target == b->cycle_target;
+}
+
+static bool nvs_state_read_slot(nvs_handle_t handle, const char *key, nvs_state_record_t *out) {
+    size_t len = sizeof(*out);
+    if (nvs_get_blob(handle, key, out, &len) != ESP_OK || len != sizeof(*out)) {
+        return false;
+    }
+    if (out->version != NVS_STATE_VERSION || out->crc != nvs_state_crc(out)) {
+        ESP_LOGW(TAG, "NVS: %s invalid (version/CRC)", key);
+        return false;
+    }
+    return true;
+}
+
+static void nvs_state_write(bool urgent) {
+    nvs_state_record_t rec = { 0 };
+    system_snapshot_t snap;
+    sys_data_snapshot(&snap);
+
+    rec.version = NVS_STATE_VERSION;
+    rec.work_mode = (uint8_t)snap.mode;
+    rec.shift_state = (uint8_t)snap.shift;
+    rec.work_t = time_accounting_get(ACCT_WORK);
+    rec.idle_t = time_accounting_get(ACCT_IDLE);
+    rec.planned_t = time_accounting_get(ACCT_PLANNED);
+    rec.durus_t = time_accounting_get(ACCT_DURUS);
+    rec.prod_cnt = snap.produced_count;
+    rec.target_cnt = snap.data.target_count;
+    rec.cycle_target = led_strip_get_cycle_target();
+    rec.last_upd = time_service_now();
+
+    if (s_last_valid && nvs_state_same_content(&rec, &s_last_record)) {
+        ESP_LOGD(TAG, "State unchanged, save skipped");
+        return;
+    }
+    rec.seq = s_last_valid ? s_last_record.seq + 1 : 0;
+    rec.crc = nvs_state_crc(&rec);
+
+    nvs_handle_t my_handle;
+    if (nvs_open("storage", NVS_READWRITE, &my_handle) != ESP_OK) {
+        return;
+    }
+    esp_err_t err = nvs_set_blob(my_handle, (rec.seq & 1) ? NVS_STATE_KEY_B : NVS_STATE_KEY_A,
+                                 &rec, sizeof(rec));
+    if (err == ESP_OK && s_legacy_keys) {
+        for (size_t i = 0; i < sizeof(s_legacy_state_keys) / sizeof(s_legacy_state_keys[0]); i++) {
+            nvs_erase_key(my_handle, s_legacy_state_keys[i]);
+        }
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(my_handle);
+    }
+    nvs_close(my_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "State save failed: %s", esp_err_to_name(err));
+        return;
+    }
+
+    if (s_legacy_keys) {
+        ESP_LOGI(TAG, "Legacy state keys migrated to blob");
+        s_legacy_keys = false;
+    }
+    s_last_record = rec;
+    s_last_valid = true;
+    ESP_LOGI(TAG, "%s saved (Mode:%d, Prod:%lu, seq:%lu)",
+             urgent ? "Urgent" : "Periodic",
+             rec.work_mode, (unsigned long)rec.prod_cnt, (unsigned long)rec.seq);
+}
+
 // ============ NVS Save Task ============
 
 static void nvs_save_task(void *pvParameters) {
@@ -39,34 +158,8 @@ static void nvs_save_task(void *pvParameters) {
             
             // Urgent: throttle atla. Normal: 2 saniye arayla kaydet.
             if (urgent || (now - last_save_time) >= 2000) {
-                nvs_handle_t my_handle;
-                esp_err_t err = nvs_open("storage", NVS_READWRITE, &my_handle);
-                if (err == ESP_OK) {
-                    // valid=0: yazim basliyor
-                    nvs_set_u8(my_handle, "valid", 0);
-                    nvs_commit(my_handle);
-
-                    nvs_set_u8(my_handle, "work_mode", (uint8_t)current_mode);
-                    nvs_set_u8(my_handle, "shift_state", (uint8_t)shift_state);
-                    nvs_set_u32(my_handle, "work_time", sys_data.work_time);
-                    nvs_set_u32(my_handle, "idle_time", sys_data.idle_time);
-                    nvs_set_u32(my_handle, "planned_time", sys_data.planned_time);
-                    nvs_set_u32(my_handle, "produced_cnt", sys_data.produced_count);
-                    nvs_set_u32(my_handle, "target_cnt", sys_data.target_count);
-                    nvs_set_u32(my_handle, "cycle_target", led_strip_get_cycle_target());
-                    nvs_set_u32(my_handle, "durus_time", sys_data.durus_time);
-                    nvs_set_u32(my_handle, "last_update", rtc_get_wall_time_seconds());
-
-                    // valid=1: tum veriler yazildi
-                    nvs_set_u8(my_handle, "valid", 1);
-                    nvs_commit(my_handle);
-                    nvs_close(my_handle);
-                    
-                    ESP_LOGI(TAG, "%s saved (Mode:%d, Prod:%lu)",
-                             urgent ? "Urgent" : "Periodic",
-                             current_mode, (unsigned long)sys_data.produced_count);
-                    last_save_time = now;
-                }
+                nvs_state_write(urgent);
+                last_save_time = now;
             }
         }
     }
@@ -166,6 +259,29 @@ uint8_t nvs_storage_load_brightness(void) {
     return level;
 }
 
+void nvs_storage_save_ir_keymap(const void *blob, size_t len) {
+    nvs_handle_t my_handle;
+    esp_err_t err = nvs_open("storage", NVS_READWRITE, &my_handle);
+    if (err == ESP_OK) {
+        nvs_set_blob(my_handle, "ir_keymap", blob, len);
+        nvs_commit(my_handle);
+        nvs_close(my_handle);
+        ESP_LOGI(TAG, "IR keymap saved (%u bytes)", (unsigned)len);
+    }
+}
+
+size_t nvs_storage_load_ir_keymap(void *blob, size_t max_len) {
+    nvs_handle_t my_handle;
+    size_t len = max_len;
+    esp_err_t err = nvs_open("storage", NVS_READONLY, &my_handle);
+    if (err != ESP_OK) {
+        return 0;
+    }
+    err = nvs_get_blob(my_handle, "ir_keymap", blob, &len);
+    nvs_close(my_handle);
+    return (err == ESP_OK) ? len : 0;
+}
+
 void nvs_storage_save_state(void) {
     if (nvs_save_queue != NULL) {
         uint8_t msg = NVS_SAVE_THROTTLED;
@@ -173,43 +289,78 @@ void nvs_storage_save_state(void) {
     }
 }
 
+// Eski format: anahtar başına değer + valid bayrağı (blob öncesi kayıtlar)
+static bool nvs_state_load_legacy(nvs_handle_t my_handle, system_state_backup_t *state) {
+    // Once valid flag kontrol et (partial write korumasi)
+    uint8_t v = 0;
+    nvs_get_u8(my_handle, "valid", &v);
+    if (v != 1) {
+        return false;
+    }
+    if (nvs_get_u8(my_handle, "work_mode", &state->work_mode) != ESP_OK) {
+        return false;
+    }
+    nvs_get_u8(my_handle, "shift_state", &state->shift_state);
+    nvs_get_u32(my_handle, "work_time", &state->work_t);
+    nvs_get_u32(my_handle, "idle_time", &state->idle_t);
+    nvs_get_u32(my_handle, "planned_time", &state->planned_t);
+    nvs_get_u32(my_handle, "produced_cnt", &state->prod_cnt);
+    nvs_get_u32(my_handle, "target_cnt", &state->target_cnt);
+    nvs_get_u32(my_handle, "cycle_target", &state->cycle_target);
+    nvs_get_u32(my_handle, "durus_time", &state->durus_t);
+    nvs_get_u32(my_handle, "last_update", &state->last_upd);
+    return true;
+}
+
 system_state_backup_t nvs_storage_load_state(void) {
     system_state_backup_t state = {0};
     state.valid = false;
     nvs_handle_t my_handle;
     esp_err_t err = nvs_open("storage", NVS_READONLY, &my_handle);
-    if (err == ESP_OK) {
-        // Once valid flag kontrol et (partial write korumasi)
-        uint8_t v = 0;
-        nvs_get_u8(my_handle, "valid", &v);
-        if (v != 1) {
-            ESP_LOGW(TAG, "NVS: valid flag eksik, fresh start");
-            nvs_close(my_handle);
-            return state;
-        }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "NVS: Open failed (%s), fresh start", esp_err_to_name(err));
+        return state;
+    }
 
-        err = nvs_get_u8(my_handle, "work_mode", &state.work_mode);
-        if (err == ESP_OK) {
-            state.valid = true;
-            nvs_get_u8(my_handle, "shift_state", &state.shift_state);
-            nvs_get_u32(my_handle, "work_time", &state.work_t);
-            nvs_get_u32(my_handle, "idle_time", &state.idle_t);
-            nvs_get_u32(my_handle, "planned_time", &state.planned_t);
-            nvs_get_u32(my_handle, "produced_cnt", &state.prod_cnt);
-            nvs_get_u32(my_handle, "target_cnt", &state.target_cnt);
-            nvs_get_u32(my_handle, "cycle_target", &state.cycle_target);
-            nvs_get_u32(my_handle, "durus_time", &state.durus_t);
-            nvs_get_u32(my_handle, "last_update", &state.last_upd);
-            
-            ESP_LOGI(TAG, "State loaded (Mode:%d, Work:%lu, Prod:%lu)", 
-                     state.work_mode, (unsigned long)state.work_t, (unsigned long)state.prod_cnt);
-        } else {
-            ESP_LOGW(TAG, "NVS: work_mode not found, fresh start");
-        }
-        nvs_close(my_handle);
+    // CRC'si geçen en yeni slot (seq taşması için fark işaretli karşılaştırılır)
+    nvs_state_record_t a, b;
+    bool a_ok = nvs_state_read_slot(my_handle, NVS_STATE_KEY_A, &a);
+    bool b_ok = nvs_state_read_slot(my_handle, NVS_STATE_KEY_B, &b);
+    const nvs_state_record_t *rec = NULL;
+    if (a_ok && b_ok) {
+        rec = ((int32_t)(b.seq - a.seq) > 0) ? &b : &a;
+    } else if (a_ok) {
+        rec = &a;
+    } else if (b_ok) {
+        rec = &b;
+    }
+
+    if (rec != NULL) {
+        state.valid = true;
+        state.work_mode = rec->work_mode;
+        state.shift_state = rec->shift_state;
+        state.work_t = rec->work_t;
+        state.idle_t = rec->idle_t;
+        state.planned_t = rec->planned_t;
+        state.prod_cnt = rec->prod_cnt;
+        state.target_cnt = rec->target_cnt;
+        state.cycle_target = rec->cycle_target;
+        state.durus_t = rec->durus_t;
+        state.last_upd = rec->last_upd;
+        s_last_record = *rec;
+        s_last_valid = true;
+        ESP_LOGI(TAG, "State loaded (Mode:%d, Work:%lu, Prod:%lu, seq:%lu)",
+                 state.work_mode, (unsigned long)state.work_t, (unsigned long)state.prod_cnt,
+                 (unsigned long)rec->seq);
+    } else if (nvs_state_load_legacy(my_handle, &state)) {
+        state.valid = true;
+        s_legacy_keys = true;
+        ESP_LOGI(TAG, "Legacy state loaded (Mode:%d, Work:%lu, Prod:%lu)",
+                 state.work_mode, (unsigned long)state.work_t, (unsigned long)state.prod_cnt);
     } else {
-        ESP_LOGW(TAG, "NVS: Open failed (%s), fresh start", esp_err_to_name(err));
+        ESP_LOGW(TAG, "NVS: no valid state record, fresh start");
     }
+    nvs_close(my_handle);
     return state;
 }
 
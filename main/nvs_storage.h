@@ -6,6 +6,7 @@
 #define NVS_STORAGE_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include "esp_err.h"
 #include "system_state.h"
 
@@ -46,13 +47,30 @@ uint32_t nvs_storage_load_cycle_target(void);
 void nvs_storage_save_brightness(uint8_t level);
 uint8_t nvs_storage_load_brightness(void);
 
+/**
+ * @brief Öğrenilmiş IR tuş haritasını (blob) kaydet
+ * @param blob Veri
+ * @param len Boyut (byte)
+ */
+void nvs_storage_save_ir_keymap(const void *blob, size_t len);
+
+/**
+ * @brief Öğrenilmiş IR tuş haritasını yükle
+ * @param blob Çıktı buffer
+ * @param max_len Buffer boyutu
+ * @return Okunan boyut, kayıt yoksa 0
+ */
+size_t nvs_storage_load_ir_keymap(void *blob, size_t max_len);
+
 /**
  * @brief Sistem durumunu kaydet (async)
+ * Tek blob (sürüm + seq + CRC32), tek commit; içerik değişmediyse yazılmaz
  */
 void nvs_storage_save_state(void);
 
 /**
  * @brief Sistem durumunu yükle
+ * CRC'si geçen en yeni kayıt; yoksa eski anahtarlı format (ilk kayıtta taşınır)
  */
 system_state_backup_t nvs_storage_load_state(void);
 
@@ -0,0 +1,130 @@
+/*
+ * KlimasanAndonV2 - Parça Sayacı
+ * PCNT: darbeler donanımda sayılır, glitch filtresi gürültüyü eler.
+ * Task her PART_COUNTER_POLL_MS'de sayacı okur; fark varsa callback çağrılır.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "part_counter.h"
+#include "pin_config.h"
+
+#if PART_COUNTER_PIN >= 0
+#include "driver/pulse_cnt.h"
+#endif
+
+static const char *TAG = "part_counter";
+
+// Callback function
+static part_counter_callback_t g_part_callback = NULL;
+
+static volatile uint32_t s_total = 0;
+
+#if PART_COUNTER_PIN >= 0
+static pcnt_unit_handle_t s_unit = NULL;
+
+// ============ Part Counter Task ============
+
+static void part_counter_task(void *pvParameters) {
+    int last = 0;
+    TickType_t last_wake = xTaskGetTickCount();
+
+    ESP_LOGI(TAG, "Part counter task started (poll %d ms)", PART_COUNTER_POLL_MS);
+
+    while (1) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(PART_COUNTER_POLL_MS));
+
+        int count = 0;
+        if (pcnt_unit_get_count(s_unit, &count) != ESP_OK) {
+            continue;
+        }
+        // accum_count: limitte donanım sıfırlanır, sürücü toplamı korur
+        uint32_t delta = (uint32_t)count - (uint32_t)last;
+        if (delta == 0) {
+            continue;
+        }
+        last = count;
+        s_total += delta;
+
+        int64_t now_us = esp_timer_get_time();
+        ESP_LOGD(TAG, "+%lu part(s), total %lu", (unsigned long)delta, (unsigned long)s_total);
+        if (g_part_callback) {
+            g_part_callback(delta, now_us);
+        }
+    }
+}
+
+// ============ PCNT Initialization ============
+
+static esp_err_t part_counter_pcnt_init(void) {
+    pcnt_unit_config_t unit_cfg = {
+        .low_limit = -1,
+        .high_limit = PART_COUNTER_HIGH_LIMIT,
+        .flags.accum_count = 1,
+    };
+    esp_err_t ret = pcnt_new_unit(&unit_cfg, &s_unit);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "PCNT unit failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    pcnt_glitch_filter_config_t filter_cfg = {
+        .max_glitch_ns = PART_COUNTER_GLITCH_NS,
+    };
+    pcnt_unit_set_glitch_filter(s_unit, &filter_cfg);
+
+    pcnt_chan_config_t chan_cfg = {
+        .edge_gpio_num = PART_COUNTER_PIN,
+        .level_gpio_num = -1,
+    };
+    pcnt_channel_handle_t chan = NULL;
+    ret = pcnt_new_channel(s_unit, &chan_cfg, &chan);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "PCNT channel failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    // Düşen kenar = parça (açık-kolektör çıkış LOW çeker)
+    pcnt_channel_set_edge_action(chan, PCNT_CHANNEL_EDGE_ACTION_HOLD, PCNT_CHANNEL_EDGE_ACTION_INCREASE);
+
+    // accum_count için limit izleme noktası gerekli
+    pcnt_unit_add_watch_point(s_unit, PART_COUNTER_HIGH_LIMIT);
+
+    pcnt_unit_enable(s_unit);
+    pcnt_unit_clear_count(s_unit);
+    pcnt_unit_start(s_unit);
+    ESP_LOGI(TAG, "PCNT part counter on GPIO%d (glitch filter %d ns)", PART_COUNTER_PIN, PART_COUNTER_GLITCH_NS);
+    return ESP_OK;
+}
+#endif
+
+// ============ Public Functions ============
+
+esp_err_t part_counter_init(void) {
+#if PART_COUNTER_PIN >= 0
+    return part_counter_pcnt_init();
+#else
+    ESP_LOGI(TAG, "Part counter disabled (PART_COUNTER_PIN < 0)");
+    return ESP_OK;
+#endif
+}
+
+void part_counter_start_task(void) {
+#if PART_COUNTER_PIN >= 0
+    if (s_unit != NULL) {
+        // Core 1, Priority 3: okuma kısa, gecikme POLL_MS'ye göre önemsiz
+        xTaskCreatePinnedToCore(part_counter_task, "part_counter", 3072, NULL, 3, NULL, 1);
+    }
+#endif
+}
+
+void part_counter_set_callback(part_counter_callback_t callback) {
+    g_part_callback = callback;
+}
+
+uint32_t part_counter_get_total(void) {
+    return s_total;
+}
@@ -0,0 +1,53 @@
+/*
+ * KlimasanAndonV2 - Parça Sayacı
+ * Makine "parça bitti" darbelerini PCNT donanımında sayar (darbe başına CPU yok).
+ * Task sayacı periyodik toplu okur ve yeni parçaları callback ile bildirir.
+ */
+#ifndef PART_COUNTER_H
+#define PART_COUNTER_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// Glitch filtresi: bundan kısa darbeler sayılmaz (ESP32 üst sınırı ~12.7us)
+#ifndef PART_COUNTER_GLITCH_NS
+#define PART_COUNTER_GLITCH_NS      10000
+#endif
+
+// Toplu okuma periyodu: zaman damgası çözünürlüğü bu kadardır
+#ifndef PART_COUNTER_POLL_MS
+#define PART_COUNTER_POLL_MS        20
+#endif
+
+// PCNT donanım sayacı sınırı (aşılınca accum_count ile yazılımda birikir)
+#define PART_COUNTER_HIGH_LIMIT     30000
+
+/**
+ * @brief Yeni parça callback'i
+ * @param count Son okumadan beri sayılan parça
+ * @param timestamp_us Okuma anı (esp_timer); son parça en fazla PART_COUNTER_POLL_MS önce
+ */
+typedef void (*part_counter_callback_t)(uint32_t count, int64_t timestamp_us);
+
+/**
+ * @brief PCNT birimini kur (PART_COUNTER_PIN < 0 ise hiçbir şey yapmaz)
+ * @return ESP_OK başarılı
+ */
+esp_err_t part_counter_init(void);
+
+/**
+ * @brief Toplu okuma task'ını başlat
+ */
+void part_counter_start_task(void);
+
+/**
+ * @brief Callback ayarla
+ */
+void part_counter_set_callback(part_counter_callback_t callback);
+
+/**
+ * @brief Açılıştan beri sayılan toplam darbe
+ */
+uint32_t part_counter_get_total(void);
+
+#endif // PART_COUNTER_H
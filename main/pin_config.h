@@ -40,6 +40,9 @@
 #define I2C_SDA_PIN     25
 #define I2C_SCL_PIN     33
 #define DS1307_ADDR     0x68
+// DS1307 SQW/OUT: 1 Hz saniye kesmesi (açık-drenaj, harici pull-up gerekir).
+// Mevcut kartta boş GPIO yok: -1 = kullanılmıyor, saniye yoklama ile bulunur
+#define RTC_SQW_PIN     -1
 
 // ============ IR Sensör ============
 #define IR_SENSOR_PIN   27
@@ -50,6 +53,11 @@
 #define BUTTON_YELLOW_PIN   36  // Sarı - PLANNED moduna geç
 #define BUTTON_ORANGE_PIN   39  // Turuncu - Adet +1
 
+// ============ Parça Sayacı (PCNT) ============
+// Makine "parça bitti" sinyali (açık-kolektör, harici pull-up, düşen kenar sayılır).
+// -1 = kullanılmıyor; adet sadece Turuncu buton / IR ile artar
+#define PART_COUNTER_PIN    -1
+
 // ============ Buzzer ============
 #define BUZZER_PIN      32
 
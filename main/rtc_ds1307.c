@@ -78,6 +78,30 @@ static uint8_t bin_to_bcd(uint8_t value) {
     return ((value / 10U) << 4) | (value % 10U);
 }
 
+// 1970-01-01'den beri gün sayısı (Howard Hinnant days_from_civil, proleptik Gregoryen)
+static int32_t days_from_civil(int32_t year, uint32_t month, uint32_t day) {
+    year -= (month <= 2U) ? 1 : 0;
+    const int32_t era = (year >= 0 ? year : year - 399) / 400;
+    const uint32_t yoe = (uint32_t)(year - era * 400);                              // [0, 399]
+    const uint32_t doy = (153U * (month > 2U ? month - 3U : month + 9U) + 2U) / 5U + day - 1U; // [0, 365]
+    const uint32_t doe = yoe * 365U + yoe / 4U - yoe / 100U + doy;                  // [0, 146096]
+    return era * 146097 + (int32_t)doe - 719468;
+}
+
+// Takvim alanları TZ'siz (yerel saat = epoch) olarak tamsayı aritmetiği ile çevrilir
+static esp_err_t ds1307_tm_to_epoch(const struct tm *tm, time_t *epoch_out) {
+    if (tm->tm_mon < 0 || tm->tm_mon > 11 || tm->tm_mday < 1) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    int32_t days = days_from_civil(tm->tm_year + 1900, (uint32_t)tm->tm_mon + 1U, (uint32_t)tm->tm_mday);
+    *epoch_out = (time_t)days * 86400 + tm->tm_hour * 3600 + tm->tm_min * 60 + tm->tm_sec;
+    return ESP_OK;
+}
+
+// ============ Register Map ============
+#define DS1307_REG_CONTROL      0x07
+#define DS1307_CTRL_SQWE        0x10    // Kare dalga açık, RS1:RS0 = 00 → 1 Hz
+
 // ============ Public Functions ============
 
 esp_err_t rtc_ds1307_init(void) {
@@ -102,11 +126,11 @@ esp_err_t rtc_ds1307_init(void) {
 
     ds1307_start_if_halted();
 
+    // Tek okuma: epoch ve log aynı register kopyasından (saniye sınırını bölmez)
     time_t ds_now = 0;
-    if (rtc_ds1307_get_epoch(&ds_now) == ESP_OK) {
+    struct tm tm_buf;
+    if (rtc_ds1307_read_tm(&tm_buf) == ESP_OK && ds1307_tm_to_epoch(&tm_buf, &ds_now) == ESP_OK) {
         ds1307_available = true;
-        struct tm tm_buf;
-        localtime_r(&ds_now, &tm_buf);
         ESP_LOGI(TAG, "DS1307 RTC ready (epoch=%lld, %04d-%02d-%02d %02d:%02d:%02d)",
                  (long long)ds_now,
                  tm_buf.tm_year + 1900,
@@ -189,27 +213,17 @@ esp_err_t rtc_ds1307_get_epoch(time_t *epoch_out) {
     if (ret != ESP_OK) {
         return ret;
     }
-
-    time_t epoch = mktime(&tm_snapshot);
-    if (epoch == (time_t)-1) {
-        return ESP_FAIL;
-    }
-
-    *epoch_out = epoch;
-    return ESP_OK;
+    return ds1307_tm_to_epoch(&tm_snapshot, epoch_out);
 }
 
-uint32_t rtc_get_wall_time_seconds(void) {
-    time_t epoch = 0;
-    if (ds1307_available) {
-        if (rtc_ds1307_get_epoch(&epoch) == ESP_OK) {
-            return (uint32_t)epoch;
-        }
-        ESP_LOGW(TAG, "DS1307 read failed, falling back to system time");
-        ds1307_available = false;
+esp_err_t rtc_ds1307_set_sqw_1hz(bool enable) {
+    esp_err_t ret = ds1307_write_register(DS1307_REG_CONTROL, enable ? DS1307_CTRL_SQWE : 0x00);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "DS1307 SQW config failed: %s", esp_err_to_name(ret));
+        return ret;
     }
-    epoch = time(NULL);
-    return (uint32_t)epoch;
+    ESP_LOGI(TAG, "DS1307 SQW/OUT %s", enable ? "1 Hz" : "disabled");
+    return ESP_OK;
 }
 
 esp_err_t rtc_ds1307_set_time(uint8_t hours, uint8_t minutes) {
@@ -36,13 +36,6 @@ esp_err_t rtc_ds1307_get_epoch(time_t *epoch_out);
  */
 esp_err_t rtc_ds1307_read_tm(struct tm *out);
 
-/**
- * @brief Wall time (saniye cinsinden) al
- * RTC varsa RTC'den, yoksa sistem zamanından
- * @return Epoch saniye
- */
-uint32_t rtc_get_wall_time_seconds(void);
-
 /**
  * @brief RTC zamanını ayarla
  * @param hours Saat (0-23)
@@ -51,4 +44,11 @@ uint32_t rtc_get_wall_time_seconds(void);
  */
 esp_err_t rtc_ds1307_set_time(uint8_t hours, uint8_t minutes);
 
+/**
+ * @brief SQW/OUT pininde 1 Hz kare dalgayı aç/kapat (control register)
+ * @param enable true: 1 Hz, false: çıkış kapalı
+ * @return ESP_OK başarılı
+ */
+esp_err_t rtc_ds1307_set_sqw_1hz(bool enable);
+
 #endif // RTC_DS1307_H
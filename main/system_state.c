@@ -0,0 +1,86 @@
+/*
+ * KlimasanAndonV2 - Sistem Durumu
+ * Global durum tanımları ve seqlock tabanlı tutarlı snapshot
+ */
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "system_state.h"
+
+// ============ Global Değişken Tanımları ============
+volatile system_data_t sys_data = {0};
+work_mode_t current_mode = MODE_STANDBY;
+shift_state_t shift_state = SHIFT_RUNNING;
+
+static _Atomic uint32_t s_produced_count = 0;
+
+// ============ Seqlock ============
+// Yazarlar birbirini mutex ile dışlar; seq yazım boyunca tek kalır.
+// Okuyucular kilit almaz: seq çift ve kopya öncesi/sonrası aynıysa kopya tutarlıdır.
+static _Atomic uint32_t s_sys_seq = 0;
+static SemaphoreHandle_t s_sys_write_mutex = NULL;
+static uint32_t s_sys_write_depth = 0;     // Sadece mutex sahibi değiştirir
+
+#define SYS_SNAPSHOT_SPIN_LIMIT     16     // Sonra yazarın bitirmesi için 1 tick uyu
+
+void system_state_init(void) {
+    if (s_sys_write_mutex == NULL) {
+        s_sys_write_mutex = xSemaphoreCreateRecursiveMutex();
+    }
+}
+
+void sys_data_write_begin(void) {
+    xSemaphoreTakeRecursive(s_sys_write_mutex, portMAX_DELAY);
+    if (s_sys_write_depth++ == 0) {
+        atomic_fetch_add_explicit(&s_sys_seq, 1, memory_order_relaxed);  // Tek: yazım sürüyor
+        atomic_thread_fence(memory_order_release);
+    }
+}
+
+void sys_data_write_end(void) {
+    if (--s_sys_write_depth == 0) {
+        atomic_fetch_add_explicit(&s_sys_seq, 1, memory_order_release);  // Çift: tamamlandı
+    }
+    xSemaphoreGiveRecursive(s_sys_write_mutex);
+}
+
+void sys_data_snapshot(system_snapshot_t *out) {
+    uint32_t spins = 0;
+    while (1) {
+        uint32_t seq = atomic_load_explicit(&s_sys_seq, memory_order_acquire);
+        if ((seq & 1U) == 0) {
+            out->data = *(const system_data_t *)&sys_data;
+            out->mode = current_mode;
+            out->shift = shift_state;
+            out->produced_count = atomic_load_explicit(&s_produced_count, memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&s_sys_seq, memory_order_relaxed) == seq) {
+                out->seq = seq;
+                return;
+            }
+        }
+        // Yazar (düşük öncelikli olabilir) bölümünü bitirsin
+        if (++spins >= SYS_SNAPSHOT_SPIN_LIMIT) {
+            spins = 0;
+            vTaskDelay(1);
+        }
+    }
+}
+
+uint32_t sys_produced_get(void) {
+    return atomic_load_explicit(&s_produced_count, memory_order_relaxed);
+}
+
+uint32_t sys_produced_add(uint32_t count) {
+    return atomic_fetch_add_explicit(&s_produced_count, count, memory_order_relaxed) + count;
+}
+
+void sys_produced_set(uint32_t count) {
+    atomic_store_explicit(&s_produced_count, count, memory_order_relaxed);
+}
+
+uint32_t sys_data_seq(void) {
+    return atomic_load_explicit(&s_sys_seq, memory_order_acquire);
+}
@@ -26,19 +26,13 @@ typedef enum {
 
 // ============ Sistem Verileri ============
 typedef struct {
-    // Zaman sayaçları (saniye)
-    uint32_t work_time;         // Çalışma zamanı
-    uint32_t idle_time;         // Atıl zaman
-    uint32_t planned_time;      // Planlı duruş
+    // Zaman sayaçları (çalışma/atıl/planlı/duruş) time_accounting modülünde tutulur
     
     // Duruş süresi (WORK dışında çalışır)
-    uint32_t durus_time;        // Mevcut duruş süresi (saniye)
-    uint32_t durus_start_epoch; // Duruş başlangıç zamanı (epoch)
     bool durus_running;         // Duruş sayacı çalışıyor mu
     
-    // Adet sayaçları
+    // Adet sayaçları (gerçekleşen adet: sys_produced_* atomik sayaç)
     uint32_t target_count;      // Hedef adet
-    uint32_t produced_count;    // Gerçekleşen adet
     
     // Cycle bar (LED strip)
     uint32_t cycle_target_seconds;  // IR'dan alınan hedef süre
@@ -48,6 +42,7 @@ typedef struct {
     
     // RTC saat (epoch)
     uint32_t current_epoch;     // Mevcut zaman (RTC'den)
+    int64_t tick_edge_us;       // Son saniye kenarı (esp_timer): ekran saat ve sayaçları bu anda değerlendirir
     
     // Ekran durumu
     bool screen_on;             // Ekran açık/kapalı
@@ -62,8 +57,9 @@ typedef struct {
     bool clock_blink_on;        // Yan-sön durumu
     
     // Menü ayarları yardımcıları
-    uint8_t menu_step;          // 0:Kapalı, 1:Parlaklık, 2:Süre
+    uint8_t menu_step;          // 0:Kapalı, 1:Parlaklık, 2:Süre, 3:IR öğrenme
     uint8_t led_brightness_idx; // 1-5 arası parlaklık seviyesi
+    uint8_t ir_learn_step;      // IR öğrenme: beklenen tuş sırası (1'den başlar)
 } system_data_t;
 
 // ============ NVS Backup Yapısı ============
@@ -85,6 +81,67 @@ typedef struct {
 extern volatile system_data_t sys_data;
 extern work_mode_t current_mode;
 extern shift_state_t shift_state;
-extern portMUX_TYPE sys_data_mux;
+
+// ============ Tutarlı Snapshot (seqlock) ============
+// sys_data + current_mode + shift_state'in aynı andan alınmış kopyası
+typedef struct {
+    system_data_t data;
+    work_mode_t mode;
+    shift_state_t shift;
+    uint32_t produced_count;    // Gerçekleşen adet (kopya anındaki)
+    uint32_t seq;               // Kopyanın alındığı yazım sırası (çift)
+} system_snapshot_t;
+
+/**
+ * @brief Seqlock'u hazırla (app_main'in en başında, task'lardan önce)
+ */
+void system_state_init(void);
+
+/**
+ * @brief Yazım bölümünü başlat: sys_data/current_mode/shift_state değişiklikleri
+ * begin/end arasında yapılır. İç içe çağrılabilir (aynı task).
+ * Yazım bölümü içinde sys_data_snapshot ÇAĞRILMAZ (kendi yazımını bekler).
+ */
+void sys_data_write_begin(void);
+
+/**
+ * @brief Yazım bölümünü bitir ve değişiklikleri okuyuculara yayınla
+ */
+void sys_data_write_end(void);
+
+/**
+ * @brief Tutarlı kopya al (kilitsiz; yazım sürüyorsa tekrar dener)
+ * @param out Çıktı snapshot
+ */
+void sys_data_snapshot(system_snapshot_t *out);
+
+// ============ Gerçekleşen Adet (atomik) ============
+// Bağımsız sayaç: başka veri yayınlamaz, relaxed sıralama yeterli.
+// Artırma yazım bölümü gerektirmez (kesme/ISR bağlamından da güvenli).
+
+/**
+ * @brief Gerçekleşen adedi oku
+ * @return Adet
+ */
+uint32_t sys_produced_get(void);
+
+/**
+ * @brief Gerçekleşen adede ekle
+ * @param count Eklenecek adet
+ * @return Yeni değer
+ */
+uint32_t sys_produced_add(uint32_t count);
+
+/**
+ * @brief Gerçekleşen adedi ayarla (reset, NVS geri yükleme)
+ * @param count Yeni değer
+ */
+void sys_produced_set(uint32_t count);
+
+/**
+ * @brief Güncel yazım sırası (değişiklik tespiti için)
+ * @return Sıra numarası (tek = yazım sürüyor)
+ */
+uint32_t sys_data_seq(void);
 
 #endif // SYSTEM_STATE_H
@@ -0,0 +1,134 @@
+/*
+ * KlimasanAndonV2 - Zaman Muhasebesi
+ * Her sayaç "birikmiş süre + açık segmentin başlangıcı" olarak tutulur. Süreler
+ * esp_timer mikrosaniyesinden hesaplanır: duvar saati ayarı (IR saat menüsü,
+ * RTC resync) sayaçları etkilemez. Değerler sadece okunduğunda hesaplanır.
+ *
+ * Segment sınırları en yakın duvar saati saniye kenarına yuvarlanır: sayaçlar
+ * saat haneleriyle aynı anda artar. Kapanan ve açılan segment aynı kenarı
+ * paylaştığı için toplam süre korunur (yuvarlama sayaçlar arasında kaymaz).
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "time_accounting.h"
+#include "time_service.h"
+#include "system_state.h"
+#include "work_mode.h"
+
+#define ACCT_US_PER_SEC     1000000LL
+#define ACCT_READ_SPIN_LIMIT    16     // Sonra yazarın bitirmesi için 1 tick uyu
+
+// Segment verisi seqlock ile yayınlanır: yazarlar (sync/set/add) zaten
+// sys_data yazım bölümündedir (mutex ile sıralı), okuyucular kilitsiz tekrar dener.
+// Segment verisi için kesme maskelenmez. Sınır hesabı (time_service_second_start_us)
+// duvar saati tabanını SQW ISR ile paylaştığı için time_service'in kısa kritik
+// bölümünden geçer: sabit 4 kelimelik kopya, sayaç verisi kilit altında değil.
+static _Atomic uint32_t s_acct_seq = 0;
+static int64_t s_accumulated_us[ACCT_COUNT];
+static int64_t s_segment_start_us[ACCT_COUNT];
+static _Atomic uint32_t s_running_mask = 0;    // bit = acct_counter_t
+
+// Olay anına en yakın saniye kenarı (esp_timer zamanı)
+static int64_t time_accounting_boundary_us(int64_t now_us) {
+    return time_service_second_start_us(now_us + ACCT_US_PER_SEC / 2);
+}
+
+static void time_accounting_write_begin(void) {
+    atomic_fetch_add_explicit(&s_acct_seq, 1, memory_order_relaxed);  // Tek: yazım sürüyor
+    atomic_thread_fence(memory_order_release);
+}
+
+static void time_accounting_write_end(void) {
+    atomic_fetch_add_explicit(&s_acct_seq, 1, memory_order_release);  // Çift: tamamlandı
+}
+
+// Sistem durumuna göre çalışması gereken sayaçlar (kural: work_mode.c)
+static uint32_t time_accounting_desired_mask(void) {
+    work_mode_state_t st = {
+        .mode = current_mode,
+        .shift = shift_state,
+        .screen_on = sys_data.screen_on,
+        .counting_active = sys_data.counting_active,
+        .durus_running = sys_data.durus_running,
+    };
+    return work_mode_counter_mask(&st);
+}
+
+void time_accounting_sync(void) {
+    uint32_t desired = time_accounting_desired_mask();
+    int64_t edge_us = time_accounting_boundary_us(esp_timer_get_time());
+    uint32_t running = atomic_load_explicit(&s_running_mask, memory_order_relaxed);
+    uint32_t changed = running ^ desired;
+    if (changed == 0) {
+        return;
+    }
+
+    time_accounting_write_begin();
+    for (int c = 0; c < ACCT_COUNT; c++) {
+        if (!(changed & (1U << c))) {
+            continue;
+        }
+        if (desired & (1U << c)) {
+            s_segment_start_us[c] = edge_us;                       // Segment aç
+        } else if (edge_us > s_segment_start_us[c]) {
+            s_accumulated_us[c] += edge_us - s_segment_start_us[c]; // Segment kapat
+        }
+    }
+    atomic_store_explicit(&s_running_mask, desired, memory_order_relaxed);
+    time_accounting_write_end();
+}
+
+uint32_t time_accounting_get(acct_counter_t counter) {
+    return time_accounting_get_at(counter, esp_timer_get_time());
+}
+
+uint32_t time_accounting_get_at(acct_counter_t counter, int64_t at_us) {
+    int64_t value_us;
+    uint32_t spins = 0;
+    while (1) {
+        uint32_t seq = atomic_load_explicit(&s_acct_seq, memory_order_acquire);
+        if (seq & 1U) {
+            // Yazım birkaç store sürer; yazar bu çekirdekte kesildiyse ona sıra ver
+            if (++spins >= ACCT_READ_SPIN_LIMIT) {
+                spins = 0;
+                vTaskDelay(1);
+            }
+            continue;
+        }
+        value_us = s_accumulated_us[counter];
+        // Segment en yakın kenardan açıldı: kenar henüz gelmediyse katkı 0
+        if ((atomic_load_explicit(&s_running_mask, memory_order_relaxed) & (1U << counter)) &&
+            at_us > s_segment_start_us[counter]) {
+            value_us += at_us - s_segment_start_us[counter];
+        }
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&s_acct_seq, memory_order_relaxed) == seq) {
+            break;
+        }
+    }
+    return (uint32_t)(value_us / ACCT_US_PER_SEC);
+}
+
+void time_accounting_set(acct_counter_t counter, uint32_t seconds) {
+    int64_t edge_us = time_accounting_boundary_us(esp_timer_get_time());
+
+    time_accounting_write_begin();
+    s_accumulated_us[counter] = (int64_t)seconds * ACCT_US_PER_SEC;
+    s_segment_start_us[counter] = edge_us;
+    time_accounting_write_end();
+}
+
+void time_accounting_add(acct_counter_t counter, uint32_t seconds) {
+    time_accounting_write_begin();
+    s_accumulated_us[counter] += (int64_t)seconds * ACCT_US_PER_SEC;
+    time_accounting_write_end();
+}
+
+bool time_accounting_is_running(void) {
+    return atomic_load_explicit(&s_running_mask, memory_order_relaxed) != 0;
+}
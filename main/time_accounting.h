@@ -0,0 +1,65 @@
+/*
+ * KlimasanAndonV2 - Zaman Muhasebesi
+ * Monotonik (esp_timer) segment zaman damgalarıyla çalışma/atıl/planlı/duruş süreleri
+ */
+#ifndef TIME_ACCOUNTING_H
+#define TIME_ACCOUNTING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============ Sayaçlar ============
+typedef enum {
+    ACCT_WORK = 0,      // Çalışma zamanı (LD3)
+    ACCT_IDLE,          // Atıl zaman (LD4)
+    ACCT_PLANNED,       // Planlı duruş (LD5)
+    ACCT_DURUS,         // Mevcut duruş süresi (LD2)
+    ACCT_COUNT
+} acct_counter_t;
+
+// Yazan fonksiyonlar (sync/set/add) sys_data yazım bölümü içinde çağrılır
+// (sys_data_write_begin/end); okuyan fonksiyonlar her yerden kilitsiz çağrılabilir.
+
+/**
+ * @brief Hangi sayaçların çalışacağını sistem durumundan yeniden değerlendir
+ * Mod, vardiya, ekran, counting_active veya durus_running değiştikten sonra çağrılır.
+ * Duran sayacın segmenti kapanır, başlayanınki açılır (O(1)).
+ */
+void time_accounting_sync(void);
+
+/**
+ * @brief Sayacın güncel değeri: birikmiş + (şimdi - segment başlangıcı)
+ * @param counter Sayaç
+ * @return Saniye
+ */
+uint32_t time_accounting_get(acct_counter_t counter);
+
+/**
+ * @brief Sayacın verilen andaki değeri (ekran: son saniye kenarında değerlendirir)
+ * @param counter Sayaç
+ * @param at_us esp_timer zamanı
+ * @return Saniye
+ */
+uint32_t time_accounting_get_at(acct_counter_t counter, int64_t at_us);
+
+/**
+ * @brief Sayacı belirli bir değere ayarla (reset, NVS geri yükleme)
+ * @param counter Sayaç
+ * @param seconds Yeni değer (saniye)
+ */
+void time_accounting_set(acct_counter_t counter, uint32_t seconds);
+
+/**
+ * @brief Sayaca süre ekle (offline süre telafisi)
+ * @param counter Sayaç
+ * @param seconds Eklenecek süre (saniye)
+ */
+void time_accounting_add(acct_counter_t counter, uint32_t seconds);
+
+/**
+ * @brief Şu an çalışan sayaç var mı
+ * @return true ise en az bir sayaç süre biriktiriyor
+ */
+bool time_accounting_is_running(void);
+
+#endif // TIME_ACCOUNTING_H
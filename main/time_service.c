@@ -0,0 +1,393 @@
+/*
+ * KlimasanAndonV2 - Time Service
+ * DS1307 açılışta bir kez okunur, sonra esp_timer mikrosaniyesiyle ilerlenir.
+ * RTC ile TIME_SERVICE_RESYNC_SEC'de bir saniye kenarına hizalanarak yeniden
+ * senkronize olunur; iki hizalı senkron arasındaki fark ile kristal kayması
+ * (drift) tahmin edilip ara zamanlara uygulanır. Okuyucular I2C'ye dokunmaz.
+ */
+#include <time.h>
+#include <stdbool.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "time_service.h"
+#include "rtc_ds1307.h"
+#include "pin_config.h"
+
+static const char *TAG = "time_service";
+
+#define US_PER_SEC          1000000LL
+#define PPB_PER_UNIT        1000000000LL
+
+// Referans noktası: s_base_us (esp_timer) anında duvar saati s_base_wall_us idi.
+// Aradaki süre s_drift_ppb ile ölçeklenir (RTC, esp_timer'dan ne kadar hızlı).
+static portMUX_TYPE s_time_mux = portMUX_INITIALIZER_UNLOCKED;
+static int64_t s_base_wall_us = 0;
+static int64_t s_base_us = 0;
+static int32_t s_drift_ppb = 0;
+
+// Son saniye-kenarı hizalı RTC okuması (drift ölçümü için). s_time_mux altında.
+// s_clock_gen her saat ayarında artar: ayardan önce başlamış resync sonucunu yazmaz.
+static bool s_edge_valid = false;
+static uint32_t s_edge_epoch = 0;
+static int64_t s_edge_us = 0;
+static uint32_t s_clock_gen = 0;
+
+// DS1307 SQW 1 Hz kenarı (RTC_SQW_PIN >= 0): ISR kenar zamanını kaydeder ve
+// kayıtlı saniye task'ını uyandırır. Kenar canlıyken saniye fazı kenardan alınır.
+static int64_t s_sqw_edge_us = 0;
+static TaskHandle_t s_tick_task = NULL;
+static volatile uint32_t s_stat_sqw_edges = 0;
+
+static volatile uint32_t s_stat_resyncs = 0;
+static volatile uint32_t s_stat_resync_failures = 0;
+static volatile int32_t s_stat_last_offset_ms = 0;
+
+static void time_service_set_base(int64_t wall_us, int64_t now_us) {
+    taskENTER_CRITICAL(&s_time_mux);
+    s_base_wall_us = wall_us;
+    s_base_us = now_us;
+    taskEXIT_CRITICAL(&s_time_mux);
+}
+
+static int64_t time_service_wall_us(int64_t now_us) {
+    taskENTER_CRITICAL(&s_time_mux);
+    int64_t wall_us = s_base_wall_us;
+    int64_t base_us = s_base_us;
+    int32_t drift_ppb = s_drift_ppb;
+    int64_t edge_us = s_sqw_edge_us;
+    taskEXIT_CRITICAL(&s_time_mux);
+
+    // SQW canlı: son kenar tam saniyedir, kenardaki saat en yakın saniyeye yuvarlanır
+    if (edge_us != 0 && edge_us <= now_us && (now_us - edge_us) < TIME_SERVICE_SQW_TIMEOUT_MS * 1000LL) {
+        int64_t edge_elapsed_us = edge_us - base_us;
+        int64_t edge_wall_us = wall_us + edge_elapsed_us + (edge_elapsed_us * drift_ppb) / PPB_PER_UNIT;
+        return ((edge_wall_us + US_PER_SEC / 2) / US_PER_SEC) * US_PER_SEC + (now_us - edge_us);
+    }
+
+    int64_t elapsed_us = now_us - base_us;
+    return wall_us + elapsed_us + (elapsed_us * drift_ppb) / PPB_PER_UNIT;
+}
+
+#if RTC_SQW_PIN >= 0
+// ============ SQW Kesmesi (RTC saniye kenarı) ============
+static void IRAM_ATTR time_service_sqw_isr(void *arg) {
+    int64_t now_us = esp_timer_get_time();
+    taskENTER_CRITICAL_ISR(&s_time_mux);
+    s_sqw_edge_us = now_us;
+    taskEXIT_CRITICAL_ISR(&s_time_mux);
+    s_stat_sqw_edges++;
+
+    if (s_tick_task != NULL) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(s_tick_task, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+static void time_service_sqw_init(void) {
+    if (rtc_ds1307_set_sqw_1hz(true) != ESP_OK) {
+        return;  // Saniye yoklama ile bulunmaya devam eder
+    }
+
+    // DS1307 saniye registerını SQW'nun düşen kenarında artırır
+    gpio_config_t io_conf = {
+        .pin_bit_mask = (1ULL << RTC_SQW_PIN),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .intr_type = GPIO_INTR_NEGEDGE,
+    };
+    gpio_config(&io_conf);
+
+    esp_err_t ret = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {  // Başka modül kurmuş olabilir
+        ESP_LOGE(TAG, "GPIO ISR service failed: %s", esp_err_to_name(ret));
+        return;
+    }
+    gpio_isr_handler_add(RTC_SQW_PIN, time_service_sqw_isr, NULL);
+    ESP_LOGI(TAG, "SQW 1 Hz tick on GPIO%d", RTC_SQW_PIN);
+}
+#endif
+
+// Bir sonraki SQW kenarını bekle (canlı değilse veya gelmezse false)
+static bool time_service_wait_sqw_edge(int64_t *edge_us_out) {
+    if (!time_service_tick_alive()) {
+        return false;
+    }
+    uint32_t edges = s_stat_sqw_edges;
+    for (int waited_ms = 0; waited_ms < TIME_SERVICE_EDGE_TIMEOUT_MS; waited_ms += 10) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+        if (s_stat_sqw_edges != edges) {
+            taskENTER_CRITICAL(&s_time_mux);
+            *edge_us_out = s_sqw_edge_us;
+            taskEXIT_CRITICAL(&s_time_mux);
+            return true;
+        }
+    }
+    return false;
+}
+
+// RTC saniyesi first'ten farklı okunana kadar oku. delay_ticks > 0 ise okumalar
+// arası uyunur. *prev_us son değişmeyen okumanın, *t_us değişen okumanın başlangıcı.
+static esp_err_t time_service_poll_rtc_second(time_t first, int64_t deadline_us, TickType_t delay_ticks,
+                                              time_t *epoch_out, int64_t *prev_us, int64_t *t_us) {
+    while (1) {
+        time_t epoch = 0;
+        int64_t now_us = esp_timer_get_time();
+        esp_err_t ret = rtc_ds1307_get_epoch(&epoch);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        if (epoch != first) {
+            *epoch_out = epoch;
+            *t_us = now_us;
+            return ESP_OK;
+        }
+        if (now_us > deadline_us) {
+            return ESP_ERR_TIMEOUT;  // Osilatör durmuş olabilir (CH biti)
+        }
+        *prev_us = now_us;
+        if (delay_ticks > 0) {
+            vTaskDelay(delay_ticks);
+        }
+    }
+}
+
+// RTC saniyesinin değiştiği anı yakala: kenar, değişmeyen son okuma ile değişen
+// ilk okumanın başlangıçlarının ortası kabul edilir.
+// SQW yoksa iki aşama: önce okumalar arası bir tick uyunarak kenar bir tick'lik
+// pencereye daraltılır, sonra ~1 s sonraki kenara kadar uyunup sadece o pencerede
+// art arda okunur (100 kHz I2C'de ~1 ms çözünürlük, CPU ~1 s meşgul edilmez).
+static esp_err_t time_service_read_rtc_edge(uint32_t *epoch_out, int64_t *edge_us_out) {
+    // SQW varsa kenarı kesme verir: kenardan hemen sonra tek okuma yeter
+    int64_t sqw_edge_us;
+    if (time_service_wait_sqw_edge(&sqw_edge_us)) {
+        time_t epoch = 0;
+        esp_err_t ret = rtc_ds1307_get_epoch(&epoch);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        *epoch_out = (uint32_t)epoch;
+        *edge_us_out = sqw_edge_us;
+        return ESP_OK;
+    }
+
+    time_t first = 0;
+    int64_t prev_us = esp_timer_get_time();
+    esp_err_t ret = rtc_ds1307_get_epoch(&first);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // 1. Kaba arama
+    time_t epoch = 0;
+    int64_t t_us = 0;
+    ret = time_service_poll_rtc_second(first, prev_us + TIME_SERVICE_EDGE_TIMEOUT_MS * 1000LL, 1,
+                                       &epoch, &prev_us, &t_us);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    *epoch_out = (uint32_t)epoch;
+    *edge_us_out = prev_us + (t_us - prev_us) / 2;
+
+    // 2. İnce arama: bir sonraki kenar aynı pencerenin 1 s sonrasında
+    int64_t guard_us = TIME_SERVICE_EDGE_GUARD_MS * 1000LL;
+    int64_t win_start_us = prev_us + US_PER_SEC - guard_us;
+    int64_t win_end_us = t_us + US_PER_SEC + guard_us;
+    int64_t sleep_us = win_start_us - esp_timer_get_time();
+    if (sleep_us >= 1000) {
+        vTaskDelay(pdMS_TO_TICKS(sleep_us / 1000));  // Aşağı yuvarlanır: erken uyanır
+    }
+    time_t fine_epoch = 0;
+    int64_t fine_prev_us = 0, fine_t_us = 0;
+    ret = time_service_poll_rtc_second(epoch, win_end_us, 0, &fine_epoch, &fine_prev_us, &fine_t_us);
+    if (ret == ESP_ERR_TIMEOUT) {
+        return ESP_OK;  // Pencere kaçtı: kaba kenar kullanılır
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    // Geç uyanıldıysa değişmeyen okuma yok (fine_prev_us = 0): kaba kenar kullanılır
+    if (fine_prev_us != 0 && fine_epoch == epoch + 1) {
+        *epoch_out = (uint32_t)fine_epoch;
+        *edge_us_out = fine_prev_us + (fine_t_us - fine_prev_us) / 2;
+    }
+    return ESP_OK;
+}
+
+// ============ Resync (kenar hizalı) + Drift Tahmini ============
+static esp_err_t time_service_resync(void) {
+    taskENTER_CRITICAL(&s_time_mux);
+    uint32_t gen = s_clock_gen;
+    bool prev_valid = s_edge_valid;
+    uint32_t prev_epoch = s_edge_epoch;
+    int64_t prev_us = s_edge_us;
+    int32_t drift = s_drift_ppb;
+    taskEXIT_CRITICAL(&s_time_mux);
+
+    uint32_t epoch;
+    int64_t edge_us;
+    esp_err_t ret = time_service_read_rtc_edge(&epoch, &edge_us);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    int64_t rtc_wall_us = (int64_t)epoch * US_PER_SEC;
+    int32_t offset_ms = (int32_t)((time_service_wall_us(edge_us) - rtc_wall_us) / 1000);
+
+    // Drift: RTC'de geçen süre / esp_timer'da geçen süre
+    if (prev_valid && epoch > prev_epoch) {
+        int64_t local_us = edge_us - prev_us;
+        int64_t rtc_us = (int64_t)(epoch - prev_epoch) * US_PER_SEC;
+        if (local_us >= TIME_SERVICE_DRIFT_MIN_SEC * US_PER_SEC) {
+            int64_t measured_ppb = ((rtc_us - local_us) * PPB_PER_UNIT) / local_us;
+            if (measured_ppb > TIME_SERVICE_DRIFT_MAX_PPB) measured_ppb = TIME_SERVICE_DRIFT_MAX_PPB;
+            if (measured_ppb < -TIME_SERVICE_DRIFT_MAX_PPB) measured_ppb = -TIME_SERVICE_DRIFT_MAX_PPB;
+
+            // Üstel ortalama (1/4): tek ölçümün kenar hatası yumuşatılır
+            drift += (int32_t)((measured_ppb - drift) / 4);
+        }
+    }
+
+    // Okuma sürerken saat ayarlandıysa bu kenar eski takvime ait: yazma
+    taskENTER_CRITICAL(&s_time_mux);
+    bool stale = (s_clock_gen != gen);
+    if (!stale) {
+        s_drift_ppb = drift;
+        s_edge_valid = true;
+        s_edge_epoch = epoch;
+        s_edge_us = edge_us;
+        s_base_wall_us = rtc_wall_us;
+        s_base_us = edge_us;
+    }
+    taskEXIT_CRITICAL(&s_time_mux);
+    if (stale) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_stat_last_offset_ms = offset_ms;
+    s_stat_resyncs++;
+    return ESP_OK;
+}
+
+static void time_sync_task(void *pvParameters) {
+    // İlk hizalı senkron açılıştan kısa süre sonra (init'teki okuma saniye fazını bilmez)
+    vTaskDelay(pdMS_TO_TICKS(TIME_SERVICE_FIRST_SYNC_SEC * 1000UL));
+
+    while (1) {
+        esp_err_t ret = time_service_resync();
+        if (ret == ESP_ERR_INVALID_STATE) {
+            // Saat ayarı resync ile çakıştı: ayarlanan saat korunur, sonraki periyot ölçer
+            ESP_LOGI(TAG, "RTC resync discarded (clock set during read)");
+        } else if (ret != ESP_OK) {
+            // Geçici I2C hatası: önbellek esp_timer + drift ile ilerlemeye devam eder,
+            // bir sonraki periyotta tekrar denenir
+            s_stat_resync_failures++;
+            ESP_LOGW(TAG, "RTC resync failed: %s", esp_err_to_name(ret));
+        } else {
+            ESP_LOGI(TAG, "RTC resync: offset %ld ms, drift %ld ppb",
+                     (long)s_stat_last_offset_ms, (long)s_drift_ppb);
+        }
+        vTaskDelay(pdMS_TO_TICKS(TIME_SERVICE_RESYNC_SEC * 1000UL));
+    }
+}
+
+// ============ Public Functions ============
+
+esp_err_t time_service_init(void) {
+    time_t epoch = 0;
+    if (rtc_ds1307_get_epoch(&epoch) == ESP_OK) {
+        time_service_set_base((int64_t)epoch * US_PER_SEC, esp_timer_get_time());
+    } else {
+        ESP_LOGW(TAG, "RTC not available, starting from system time");
+        time_service_set_base((int64_t)time(NULL) * US_PER_SEC, esp_timer_get_time());
+    }
+
+#if RTC_SQW_PIN >= 0
+    time_service_sqw_init();
+#endif
+
+    xTaskCreatePinnedToCore(time_sync_task, "time_sync", 3072, NULL, 2, NULL, 0);
+    ESP_LOGI(TAG, "Time service started (resync every %d s)", TIME_SERVICE_RESYNC_SEC);
+    return ESP_OK;
+}
+
+uint32_t time_service_now(void) {
+    return (uint32_t)(time_service_wall_us(esp_timer_get_time()) / US_PER_SEC);
+}
+
+uint32_t time_service_ms_to_next_second(void) {
+    int64_t wall_us = time_service_wall_us(esp_timer_get_time());
+    return (uint32_t)((US_PER_SEC - wall_us % US_PER_SEC) / 1000);
+}
+
+uint32_t time_service_seconds_of_day(void) {
+    // Epoch, RTC takvim alanlarından TZ'siz hesaplanır: epoch % 86400 yerel gün saniyesidir
+    return time_service_now() % 86400UL;
+}
+
+int64_t time_service_second_start_us(int64_t at_us) {
+    int64_t wall_us = time_service_wall_us(at_us);
+    return at_us - (wall_us % US_PER_SEC);
+}
+
+uint32_t time_service_epoch_at_edge(int64_t edge_us) {
+    return (uint32_t)((time_service_wall_us(edge_us) + US_PER_SEC / 2) / US_PER_SEC);
+}
+
+void time_service_set_tick_task(TaskHandle_t task) {
+    s_tick_task = task;
+}
+
+bool time_service_tick_alive(void) {
+    taskENTER_CRITICAL(&s_time_mux);
+    int64_t edge_us = s_sqw_edge_us;
+    taskEXIT_CRITICAL(&s_time_mux);
+    return edge_us != 0 && (esp_timer_get_time() - edge_us) < TIME_SERVICE_SQW_TIMEOUT_MS * 1000LL;
+}
+
+void time_service_get_hms(uint8_t *hours, uint8_t *minutes, uint8_t *seconds) {
+    uint32_t sec_of_day = time_service_seconds_of_day();
+    if (hours) *hours = sec_of_day / 3600;
+    if (minutes) *minutes = (sec_of_day / 60) % 60;
+    if (seconds) *seconds = sec_of_day % 60;
+}
+
+esp_err_t time_service_set_time(uint8_t hours, uint8_t minutes) {
+    esp_err_t ret = rtc_ds1307_set_time(hours, minutes);
+    int64_t now_us = esp_timer_get_time();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // Saniye yazımı RTC'nin saniye zincirini sıfırlar: yazım anı saniye kenarıdır.
+    // Takvim atladığı için drift referansı geçersiz.
+    uint32_t day_start = time_service_now() - time_service_seconds_of_day();
+    time_t epoch = 0;
+    if (rtc_ds1307_get_epoch(&epoch) == ESP_OK) {
+        day_start = (uint32_t)epoch - ((uint32_t)epoch % 86400UL);
+    }
+    int64_t wall_us = (int64_t)(day_start + hours * 3600UL + minutes * 60UL) * US_PER_SEC;
+    taskENTER_CRITICAL(&s_time_mux);
+    s_base_wall_us = wall_us;
+    s_base_us = now_us;
+    s_edge_valid = false;
+    s_clock_gen++;
+    taskEXIT_CRITICAL(&s_time_mux);
+    return ESP_OK;
+}
+
+void time_service_get_stats(time_service_stats_t *out) {
+    if (out == NULL) {
+        return;
+    }
+    out->drift_ppb = s_drift_ppb;
+    out->last_offset_ms = s_stat_last_offset_ms;
+    out->resyncs = s_stat_resyncs;
+    out->resync_failures = s_stat_resync_failures;
+    out->sqw_edges = s_stat_sqw_edges;
+}
@@ -0,0 +1,113 @@
+/*
+ * KlimasanAndonV2 - Time Service
+ * DS1307'ye periyodik senkronize edilen, drift düzeltmeli esp_timer tabanlı duvar saati
+ */
+#ifndef TIME_SERVICE_H
+#define TIME_SERVICE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// RTC ile yeniden senkronizasyon periyodu (saniye)
+#ifndef TIME_SERVICE_RESYNC_SEC
+#define TIME_SERVICE_RESYNC_SEC     300
+#endif
+
+// Açılıştan sonra ilk saniye-kenarı hizalı senkron
+#define TIME_SERVICE_FIRST_SYNC_SEC     10
+// Kenar beklerken vazgeçme süresi (RTC saniyesi 1 s'de değişmeli)
+#define TIME_SERVICE_EDGE_TIMEOUT_MS    1200
+// SQW yoksa: ince yoklama penceresinin tahmini kenar etrafındaki payı
+#define TIME_SERVICE_EDGE_GUARD_MS      2
+// Drift ölçümü için iki senkron arası minimum süre ve kabul edilen üst sınır
+#define TIME_SERVICE_DRIFT_MIN_SEC      60
+#define TIME_SERVICE_DRIFT_MAX_PPB      500000  // ±500 ppm
+// Bu süre SQW kenarı gelmezse tick kayıp sayılır (yoklamaya dönülür)
+#define TIME_SERVICE_SQW_TIMEOUT_MS     1500
+
+// Time service durumu
+typedef struct {
+    int32_t drift_ppb;          // RTC'nin esp_timer'a göre hız farkı (+ = RTC hızlı)
+    int32_t last_offset_ms;     // Son resync'te önbellek - RTC farkı
+    uint32_t resyncs;           // Başarılı resync sayısı
+    uint32_t resync_failures;   // Başarısız resync (I2C hatası) sayısı
+    uint32_t sqw_edges;         // Alınan SQW 1 Hz kenarı (RTC_SQW_PIN < 0 ise 0)
+} time_service_stats_t;
+
+/**
+ * @brief Time service'i başlat: RTC'yi bir kez okur, resync task'ını başlatır
+ * rtc_ds1307_init'ten sonra çağrılmalı
+ * @return ESP_OK başarılı
+ */
+esp_err_t time_service_init(void);
+
+/**
+ * @brief Duvar saati (epoch saniye) — I2C erişimi yok, O(1)
+ * @return Epoch saniye
+ */
+uint32_t time_service_now(void);
+
+/**
+ * @brief Bir sonraki duvar saati saniye sınırına kalan süre
+ * @return Milisaniye (0-1000)
+ */
+uint32_t time_service_ms_to_next_second(void);
+
+/**
+ * @brief Günün saniyesi (0-86399) — saat alanı için
+ * @return Gece yarısından beri geçen saniye
+ */
+uint32_t time_service_seconds_of_day(void);
+
+/**
+ * @brief at_us anının içinde bulunduğu duvar saati saniyesinin başladığı an
+ * @param at_us esp_timer zamanı
+ * @return Saniye kenarının esp_timer zamanı (SQW canlıysa kenar fazıyla)
+ */
+int64_t time_service_second_start_us(int64_t at_us);
+
+/**
+ * @brief Saniye kenarındaki duvar saati (kenar en yakın saniyeye yuvarlanır)
+ * @param edge_us time_service_second_start_us ile bulunan kenar
+ * @return Epoch saniye
+ */
+uint32_t time_service_epoch_at_edge(int64_t edge_us);
+
+/**
+ * @brief SQW saniye kenarında uyandırılacak task'ı kaydet (vTaskNotifyGiveFromISR)
+ * @param task Task handle (NULL = kapalı)
+ */
+void time_service_set_tick_task(TaskHandle_t task);
+
+/**
+ * @brief SQW saniye kesmesi çalışıyor mu (son kenar TIME_SERVICE_SQW_TIMEOUT_MS içinde)
+ * @return true ise saniye kenarları kesme ile geliyor
+ */
+bool time_service_tick_alive(void);
+
+/**
+ * @brief Günün saati, tamsayı aritmetiği ile (mktime/localtime yok)
+ * @param hours Saat (NULL olabilir)
+ * @param minutes Dakika (NULL olabilir)
+ * @param seconds Saniye (NULL olabilir)
+ */
+void time_service_get_hms(uint8_t *hours, uint8_t *minutes, uint8_t *seconds);
+
+/**
+ * @brief RTC saatini ayarla ve önbelleği hemen güncelle
+ * @param hours Saat (0-23)
+ * @param minutes Dakika (0-59)
+ * @return ESP_OK başarılı
+ */
+esp_err_t time_service_set_time(uint8_t hours, uint8_t minutes);
+
+/**
+ * @brief Drift tahmini ve resync istatistiklerini al
+ * @param out Çıktı
+ */
+void time_service_get_stats(time_service_stats_t *out);
+
+#endif // TIME_SERVICE_H
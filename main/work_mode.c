@@ -0,0 +1,52 @@
+/*
+ * KlimasanAndonV2 - Çalışma Modu Kuralları
+ * Tablo ve karar fonksiyonları: yan etkisiz, sadece girdilerine bakar.
+ */
+#include "work_mode.h"
+#include "time_accounting.h"
+
+// ============ Mod Geçiş Tablosu ============
+#define ACT_TO_WORK             (MODE_ACT_DURUS_STOP | MODE_ACT_LED_CLEAR | MODE_ACT_PERSIST)
+#define ACT_NEW_DURUS           (MODE_ACT_DURUS_RESET | MODE_ACT_DURUS_START | MODE_ACT_PERSIST)
+#define ACT_KEEP_DURUS          (MODE_ACT_DURUS_START | MODE_ACT_PERSIST)
+
+// [mevcut mod][hedef mod] → yapılacak işler (aynı moda geçiş: sadece tazele)
+static const uint8_t mode_transitions[MODE_COUNT][MODE_COUNT] = {
+    //                 STANDBY  WORK         IDLE            PLANNED
+    [MODE_STANDBY] = { 0,       ACT_TO_WORK, ACT_NEW_DURUS,  ACT_NEW_DURUS  },
+    [MODE_WORK]    = { 0,       0,           ACT_NEW_DURUS,  ACT_NEW_DURUS  },
+    [MODE_IDLE]    = { 0,       ACT_TO_WORK, 0,              ACT_KEEP_DURUS },
+    [MODE_PLANNED] = { 0,       ACT_TO_WORK, ACT_KEEP_DURUS, 0              },
+};
+
+uint8_t work_mode_transition(work_mode_t from, work_mode_t to) {
+    if ((unsigned)from >= MODE_COUNT || (unsigned)to >= MODE_COUNT) {
+        return 0;
+    }
+    return mode_transitions[from][to];
+}
+
+// ============ Sayma Kuralları ============
+
+uint32_t work_mode_counter_mask(const work_mode_state_t *st) {
+    if (!st->screen_on || !st->counting_active ||
+        st->mode == MODE_STANDBY || st->shift == SHIFT_STOPPED) {
+        return 0;
+    }
+
+    switch (st->mode) {
+        case MODE_WORK:
+            return 1U << ACCT_WORK;
+        case MODE_IDLE:
+            return (1U << ACCT_IDLE) | (st->durus_running ? (1U << ACCT_DURUS) : 0);
+        case MODE_PLANNED:
+            return (1U << ACCT_PLANNED) | (st->durus_running ? (1U << ACCT_DURUS) : 0);
+        default:
+            return 0;
+    }
+}
+
+bool work_mode_counts_parts(const work_mode_state_t *st) {
+    // Adet, çalışma zamanıyla aynı koşulda sayılır
+    return (work_mode_counter_mask(st) & (1U << ACCT_WORK)) != 0;
+}
@@ -0,0 +1,55 @@
+/*
+ * KlimasanAndonV2 - Çalışma Modu Kuralları
+ * Mod geçiş tablosu ve hangi durumda hangi sayacın/adedin sayıldığı.
+ * Saf mantık: donanım, zaman veya global durum okumaz (host testlerinde
+ * doğrudan çalışır). Uygulama main.c ve time_accounting.c'dedir.
+ */
+#ifndef WORK_MODE_H
+#define WORK_MODE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "system_state.h"
+
+#define MODE_COUNT              (MODE_PLANNED + 1)
+
+// ============ Geçiş Aksiyonları ============
+#define MODE_ACT_DURUS_RESET    (1U << 0)   // Yeni duruş, sıfırdan başla
+#define MODE_ACT_DURUS_START    (1U << 1)   // Duruş sayacını çalıştır
+#define MODE_ACT_DURUS_STOP     (1U << 2)   // Duruş sayacını dondur
+#define MODE_ACT_LED_CLEAR      (1U << 3)   // LED barı söndür (alarm yoksa)
+#define MODE_ACT_PERSIST        (1U << 4)   // Acil NVS kaydı
+
+// Sayaç kararını veren durum alanları (sys_data/current_mode/shift_state'ten)
+typedef struct {
+    work_mode_t mode;
+    shift_state_t shift;
+    bool screen_on;
+    bool counting_active;
+    bool durus_running;
+} work_mode_state_t;
+
+/**
+ * @brief Mod geçişinde yapılacak işler
+ * @param from Mevcut mod
+ * @param to Hedef mod
+ * @return MODE_ACT_* bayrakları (aynı moda geçiş veya geçersiz mod: 0)
+ */
+uint8_t work_mode_transition(work_mode_t from, work_mode_t to);
+
+/**
+ * @brief Durumda çalışması gereken zaman sayaçları
+ * @param st Durum
+ * @return Bit maskesi (bit = acct_counter_t)
+ */
+uint32_t work_mode_counter_mask(const work_mode_state_t *st);
+
+/**
+ * @brief Adet (Turuncu, IR Mavi, makine sinyali) bu durumda sayılır mı?
+ * Sadece çalışma zamanı sayarken: WORK modu, ekran açık, sayaç aktif, vardiya sürüyor.
+ * @param st Durum
+ * @return true ise adet eklenir
+ */
+bool work_mode_counts_parts(const work_mode_state_t *st);
+
+#endif // WORK_MODE_H
@@ -0,0 +1,310 @@
+/*
+ * KlimasanAndonV2 - IR iz tekrar oynatma: isabet / yanlış pozitif / ns/frame
+ * test/ir_traces altındaki .trace dosyalarını ir_decoder_replay ile çözer.
+ *
+ * İz formatı (IR_TRACE_LOG çıktısı ile aynı satırlar):
+ *   # expect <PROTO> <adres> <komut> [toggle=N]   beklenen çerçeve (sırayla)
+ *   # expect <PROTO> repeat                       NEC repeat kodu
+ *   # expect none                                 gürültü: hiçbir çerçeve çıkmamalı
+ *   IR trace: 9000 -4500 560 ...                  darbeler (>0 mark, <0 space)
+ *   (boş satır)                                   burst sonu = cihazdaki flush
+ * "IR trace:" önündeki log öneki (I (123) IR_REMOTE:) atlanır.
+ *
+ * Kullanım: ir_replay_bench <iz dizini> [benchmark süresi ms]
+ * Çıkış kodu: isabet oranı %100 değilse veya yanlış pozitif varsa 1.
+ *
+ * Sahipsiz NEC repeat (öncesinde aynı izde tam çerçeve yok) ayrı sayılır:
+ * repeat kodunun kendi doğrulaması yoktur, ir_remote onu ancak son geçerli
+ * çerçeveden IR_REPEAT_TIMEOUT_MS içinde kabul eder (ir_handle_repeat).
+ */
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ir_decoder.h"
+#include "test_common.h"
+
+#define BENCH_DEFAULT_MS    200
+#define BENCH_MAX_FILES     32
+#define BENCH_MAX_EXPECT    64
+#define BENCH_MAX_BURSTS    128
+#define BENCH_MAX_PULSES    512     // Burst başına (IR_TRACE_MAX_PULSES'tan büyük)
+#define BENCH_MAX_FRAMES    8       // Burst başına çözülen
+
+typedef struct {
+    ir_protocol_t protocol;
+    uint16_t address;
+    uint8_t command;
+    int toggle;             // -1 = bakılmaz
+    bool repeat;
+} expect_t;
+
+typedef struct {
+    int32_t *pulses;
+    size_t count;
+} burst_t;
+
+typedef struct {
+    char name[64];
+    bool noise;             // expect none
+    expect_t expect[BENCH_MAX_EXPECT];
+    size_t expect_count;
+    burst_t bursts[BENCH_MAX_BURSTS];
+    size_t burst_count;
+    size_t pulse_count;
+} trace_t;
+
+// ============ Ayrıştırma ============
+
+static bool parse_protocol(const char *name, ir_protocol_t *out) {
+    for (int p = 0; p < IR_PROTO_COUNT; p++) {
+        if (strcmp(name, ir_decoder_protocol_name((ir_protocol_t)p)) == 0) {
+            *out = (ir_protocol_t)p;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parse_expect(trace_t *t, const char *line) {
+    char proto[16], a[16] = "", c[16] = "", tg[16] = "";
+    int n = sscanf(line, "# expect %15s %15s %15s %15s", proto, a, c, tg);
+    if (n < 1) return false;
+    if (strcmp(proto, "none") == 0) {
+        t->noise = true;
+        return true;
+    }
+    if (t->expect_count >= BENCH_MAX_EXPECT) return false;
+    expect_t *e = &t->expect[t->expect_count];
+    memset(e, 0, sizeof(*e));
+    e->toggle = -1;
+    if (!parse_protocol(proto, &e->protocol)) return false;
+    if (n >= 2 && strcmp(a, "repeat") == 0) {
+        e->repeat = true;
+    } else if (n >= 3) {
+        e->address = (uint16_t)strtoul(a, NULL, 0);
+        e->command = (uint8_t)strtoul(c, NULL, 0);
+        if (n >= 4 && strncmp(tg, "toggle=", 7) == 0) {
+            e->toggle = atoi(tg + 7);
+        }
+    } else {
+        return false;
+    }
+    t->expect_count++;
+    return true;
+}
+
+static void burst_close(trace_t *t, int32_t *buf, size_t *len) {
+    if (*len == 0 || t->burst_count >= BENCH_MAX_BURSTS) {
+        *len = 0;
+        return;
+    }
+    burst_t *b = &t->bursts[t->burst_count++];
+    b->pulses = malloc(*len * sizeof(int32_t));
+    memcpy(b->pulses, buf, *len * sizeof(int32_t));
+    b->count = *len;
+    t->pulse_count += *len;
+    *len = 0;
+}
+
+static bool trace_load(trace_t *t, const char *path) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        printf("%s: açılamadı\n", path);
+        return false;
+    }
+    char line[1024];
+    int32_t buf[BENCH_MAX_PULSES];
+    size_t len = 0;
+    bool ok = true;
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (strncmp(line, "# expect", 8) == 0) {
+            if (!parse_expect(t, line)) {
+                printf("%s: geçersiz satır: %s", path, line);
+                ok = false;
+            }
+            continue;
+        }
+        if (line[0] == '#') continue;
+        char *p = strstr(line, "IR trace:");
+        p = (p != NULL) ? p + 9 : line;
+        char *end;
+        bool any = false;
+        for (long v = strtol(p, &end, 10); end != p; v = strtol(p, &end, 10)) {
+            if (len < BENCH_MAX_PULSES) buf[len++] = (int32_t)v;
+            p = end;
+            any = true;
+        }
+        if (!any) {
+            burst_close(t, buf, &len);   // Boş satır: burst bitti
+        }
+    }
+    burst_close(t, buf, &len);
+    fclose(f);
+    return ok;
+}
+
+static void trace_free(trace_t *t) {
+    for (size_t i = 0; i < t->burst_count; i++) {
+        free(t->bursts[i].pulses);
+    }
+}
+
+// ============ Metrikler ============
+
+static bool frame_matches(const ir_frame_t *f, const expect_t *e) {
+    if (f->protocol != e->protocol || f->repeat != e->repeat) return false;
+    if (e->repeat) return true;
+    if (f->address != e->address || f->command != e->command) return false;
+    return e->toggle < 0 || f->toggle == e->toggle;
+}
+
+typedef struct {
+    size_t frames;          // Çözülen
+    size_t hits;            // Beklenenle eşleşen
+    size_t misses;          // Çözülemeyen beklenen
+    size_t false_pos;       // Beklenmeyen çerçeve
+    size_t orphan_repeats;  // Tam çerçevesiz repeat (ir_remote eler)
+} result_t;
+
+// Beklenen liste sırayla eşleştirilir: kaçırılan çerçeve sonrakileri bozmaz
+static result_t trace_evaluate(const trace_t *t) {
+    result_t r = { 0 };
+    size_t next = 0;
+    bool owned = false;     // Bu izde repeat'in ait olabileceği tam çerçeve görüldü
+    ir_decoder_t dec = { 0 };
+    ir_frame_t frames[BENCH_MAX_FRAMES];
+
+    for (size_t b = 0; b < t->burst_count; b++) {
+        size_t n = ir_decoder_replay(&dec, t->bursts[b].pulses, t->bursts[b].count,
+                                     frames, BENCH_MAX_FRAMES);
+        r.frames += n;
+        for (size_t i = 0; i < n && i < BENCH_MAX_FRAMES; i++) {
+            if (frames[i].repeat && !owned) {
+                r.orphan_repeats++;
+                continue;
+            }
+            owned |= !frames[i].repeat;
+            size_t j = next;
+            while (j < t->expect_count && !frame_matches(&frames[i], &t->expect[j])) j++;
+            if (j < t->expect_count) {
+                r.misses += j - next;
+                r.hits++;
+                next = j + 1;
+            } else {
+                r.false_pos++;
+                printf("  %s burst %zu: beklenmeyen %s 0x%04X 0x%02X%s\n", t->name, b,
+                       ir_decoder_protocol_name(frames[i].protocol), frames[i].address,
+                       frames[i].command, frames[i].repeat ? " repeat" : "");
+            }
+        }
+    }
+    r.misses += t->expect_count - next;
+    return r;
+}
+
+// Tüm burst'leri tekrar tekrar çöz: en az min_ms süre
+static void trace_bench(trace_t *traces, size_t count, bool noise, uint32_t min_ms,
+                        double *ns_per_frame, double *ns_per_pulse) {
+    ir_decoder_t dec = { 0 };
+    ir_frame_t frames[BENCH_MAX_FRAMES];
+    uint64_t frames_total = 0, pulses_total = 0, rounds = 0;
+    uint64_t start = test_now_ns(), elapsed;
+
+    do {
+        for (size_t i = 0; i < count; i++) {
+            if (traces[i].noise != noise) continue;
+            for (size_t b = 0; b < traces[i].burst_count; b++) {
+                frames_total += ir_decoder_replay(&dec, traces[i].bursts[b].pulses,
+                                                  traces[i].bursts[b].count, frames, BENCH_MAX_FRAMES);
+                pulses_total += traces[i].bursts[b].count;
+            }
+        }
+        rounds++;
+        elapsed = test_now_ns() - start;
+    } while (elapsed < (uint64_t)min_ms * 1000000ULL);
+
+    *ns_per_frame = frames_total ? (double)elapsed / (double)frames_total : 0.0;
+    *ns_per_pulse = pulses_total ? (double)elapsed / (double)pulses_total : 0.0;
+    (void)rounds;
+}
+
+static int name_cmp(const void *a, const void *b) {
+    return strcmp(((const trace_t *)a)->name, ((const trace_t *)b)->name);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        printf("kullanım: %s <iz dizini> [benchmark ms]\n", argv[0]);
+        return 2;
+    }
+    uint32_t bench_ms = (argc >= 3) ? (uint32_t)atoi(argv[2]) : BENCH_DEFAULT_MS;
+
+    static trace_t traces[BENCH_MAX_FILES];
+    size_t count = 0;
+    DIR *dir = opendir(argv[1]);
+    if (dir == NULL) {
+        printf("%s: dizin açılamadı\n", argv[1]);
+        return 2;
+    }
+    struct dirent *de;
+    bool ok = true;
+    while ((de = readdir(dir)) != NULL && count < BENCH_MAX_FILES) {
+        size_t len = strlen(de->d_name);
+        if (len < 7 || strcmp(de->d_name + len - 6, ".trace") != 0) continue;
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s", argv[1], de->d_name);
+        trace_t *t = &traces[count++];
+        snprintf(t->name, sizeof(t->name), "%s", de->d_name);
+        ok &= trace_load(t, path);
+    }
+    closedir(dir);
+    qsort(traces, count, sizeof(traces[0]), name_cmp);
+
+    size_t expected = 0, hits = 0, fp_signal = 0, fp_noise = 0, noise_bursts = 0, orphans = 0;
+    printf("%-24s %7s %7s %7s %7s %7s %9s\n", "iz", "burst", "bekle", "isabet", "kaçan", "yanlış+",
+           "sahipsiz");
+    for (size_t i = 0; i < count; i++) {
+        trace_t *t = &traces[i];
+        if (t->noise && t->expect_count > 0) {
+            printf("%s: 'expect none' ile çerçeve beklentisi birlikte\n", t->name);
+            ok = false;
+        }
+        result_t r = trace_evaluate(t);
+        printf("%-24s %7zu %7zu %7zu %7zu %7zu %9zu\n", t->name, t->burst_count, t->expect_count,
+               r.hits, r.misses, r.false_pos, r.orphan_repeats);
+        expected += t->expect_count;
+        orphans += r.orphan_repeats;
+        hits += r.hits;
+        if (t->noise) {
+            fp_noise += r.false_pos;
+            noise_bursts += t->burst_count;
+        } else {
+            fp_signal += r.false_pos;
+        }
+    }
+
+    double hit_pct = expected ? 100.0 * (double)hits / (double)expected : 0.0;
+    printf("\nisabet: %zu/%zu (%.1f%%)\n", hits, expected, hit_pct);
+    printf("yanlış pozitif: sinyal izlerinde %zu, gürültüde %zu/%zu burst (%.2f%%)\n",
+           fp_signal, fp_noise, noise_bursts,
+           noise_bursts ? 100.0 * (double)fp_noise / (double)noise_bursts : 0.0);
+    printf("sahipsiz NEC repeat: %zu (ir_remote tarafından elenir)\n", orphans);
+
+    double ns_frame, ns_pulse;
+    trace_bench(traces, count, false, bench_ms, &ns_frame, &ns_pulse);
+    printf("çözme (sinyal): %.0f ns/frame, %.1f ns/darbe\n", ns_frame, ns_pulse);
+    trace_bench(traces, count, true, bench_ms, &ns_frame, &ns_pulse);
+    printf("çözme (gürültü): %.1f ns/darbe\n", ns_pulse);
+
+    for (size_t i = 0; i < count; i++) {
+        trace_free(&traces[i]);
+    }
+    if (count == 0 || expected == 0) {
+        printf("iz bulunamadı\n");
+        return 1;
+    }
+    return (ok && hits == expected && fp_signal == 0 && fp_noise == 0) ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+/*
+ * KlimasanAndonV2 - IR darbe dizisi üretici (host testleri)
+ * Protokol spesifikasyonundaki nominal sürelerle iz üretir; format
+ * ir_decoder_replay ile aynıdır (>0 mark, <0 space, us).
+ */
+#ifndef IR_SYNTH_H
+#define IR_SYNTH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define IR_SYNTH_MAX_PULSES     160
+
+typedef struct {
+    int32_t p[IR_SYNTH_MAX_PULSES];
+    size_t n;
+} ir_synth_t;
+
+static inline void ir_synth_pulse(ir_synth_t *s, int32_t us) {
+    if (s->n < IR_SYNTH_MAX_PULSES) {
+        s->p[s->n++] = us;
+    }
+}
+
+// NEC/Samsung: leader + 32 bit (her bayt LSB ilk), stop mark, çerçeve arası boşluk
+static inline void ir_synth_pulse_distance(ir_synth_t *s, int32_t leader_mark, const uint8_t bytes[4]) {
+    ir_synth_pulse(s, leader_mark);
+    ir_synth_pulse(s, -4500);
+    for (int i = 0; i < 4; i++) {
+        for (int k = 0; k < 8; k++) {
+            ir_synth_pulse(s, 560);
+            ir_synth_pulse(s, ((bytes[i] >> k) & 1) ? -1690 : -560);
+        }
+    }
+    ir_synth_pulse(s, 560);
+    ir_synth_pulse(s, -40000);
+}
+
+static inline void ir_synth_nec(ir_synth_t *s, const uint8_t bytes[4]) {
+    ir_synth_pulse_distance(s, 9000, bytes);
+}
+
+static inline void ir_synth_samsung(ir_synth_t *s, const uint8_t bytes[4]) {
+    ir_synth_pulse_distance(s, 4500, bytes);
+}
+
+static inline void ir_synth_nec_repeat(ir_synth_t *s) {
+    ir_synth_pulse(s, 9000);
+    ir_synth_pulse(s, -2250);
+    ir_synth_pulse(s, 560);
+    ir_synth_pulse(s, -96000);
+}
+
+// RC5: 14 bit (S1 S2 T A4..A0 C5..C0), MSB ilk; 1 = space→mark yarımları.
+// İlk yarım (space) boşta görünmez; aynı seviyeli komşu yarımlar birleşir.
+static inline void ir_synth_rc5(ir_synth_t *s, uint16_t bits14) {
+    int levels[28];
+    for (int i = 0; i < 14; i++) {
+        int b = (bits14 >> (13 - i)) & 1;
+        levels[2 * i] = !b;
+        levels[2 * i + 1] = b;
+    }
+    int i = 1;
+    while (i < 28) {
+        int level = levels[i];
+        int n = 1;
+        while (i + n < 28 && levels[i + n] == level) n++;
+        ir_synth_pulse(s, level ? 889 * n : -889 * n);
+        i += n;
+    }
+    ir_synth_pulse(s, -90000);
+}
+
+static inline uint16_t ir_synth_rc5_bits(int toggle, uint8_t address, uint8_t command) {
+    // S2 = ~command bit 6 (RC5X)
+    return (uint16_t)((1u << 13) | ((command & 0x40) ? 0 : (1u << 12)) | ((toggle & 1) << 11) |
+                      ((address & 0x1F) << 6) | (command & 0x3F));
+}
+
+// SIRC: 2.4ms leader, 7 bit command + adres, LSB ilk; bit = mark süresi
+static inline void ir_synth_sirc(ir_synth_t *s, uint8_t command, uint16_t address, int nbits) {
+    uint32_t v = (uint32_t)(command & 0x7F) | ((uint32_t)address << 7);
+    ir_synth_pulse(s, 2400);
+    for (int i = 0; i < nbits; i++) {
+        ir_synth_pulse(s, -600);
+        ir_synth_pulse(s, ((v >> i) & 1) ? 1200 : 600);
+    }
+    ir_synth_pulse(s, -25000);
+}
+
+#endif // IR_SYNTH_H
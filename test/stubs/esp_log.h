@@ -0,0 +1,17 @@
+/*
+ * Host test taklidi: ESP-IDF log makroları (çıktı yok, format argümanları derlenir)
+ */
+#ifndef STUB_ESP_LOG_H
+#define STUB_ESP_LOG_H
+
+#include <stdio.h>
+
+#define ESP_LOG_STUB(tag, fmt, ...)  do { (void)(tag); if (0) printf(fmt, ##__VA_ARGS__); } while (0)
+
+#define ESP_LOGE(tag, fmt, ...) ESP_LOG_STUB(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) ESP_LOG_STUB(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) ESP_LOG_STUB(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) ESP_LOG_STUB(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) ESP_LOG_STUB(tag, fmt, ##__VA_ARGS__)
+
+#endif // STUB_ESP_LOG_H
@@ -0,0 +1,24 @@
+/*
+ * Host test taklidi: FreeRTOS temel tipleri (sadece testlerde kullanılan kısım)
+ */
+#ifndef STUB_FREERTOS_H
+#define STUB_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "freertos/portmacro.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE              1
+#define pdFALSE             0
+#define pdPASS              pdTRUE
+#define pdFAIL              pdFALSE
+#define portMAX_DELAY       0xFFFFFFFFU
+#define configTICK_RATE_HZ  1000
+#define portTICK_PERIOD_MS  (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms) * configTICK_RATE_HZ / 1000)
+
+#endif // STUB_FREERTOS_H
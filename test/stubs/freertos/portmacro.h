@@ -0,0 +1,20 @@
+/*
+ * Host test taklidi: FreeRTOS port makroları (tek çekirdek, kritik bölge boş)
+ */
+#ifndef STUB_PORTMACRO_H
+#define STUB_PORTMACRO_H
+
+typedef struct {
+    int owner;
+    int count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    { 0, 0 }
+#define portENTER_CRITICAL(mux)         ((void)(mux))
+#define portEXIT_CRITICAL(mux)          ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux)     ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux)      ((void)(mux))
+#define taskENTER_CRITICAL(mux)         ((void)(mux))
+#define taskEXIT_CRITICAL(mux)          ((void)(mux))
+
+#endif // STUB_PORTMACRO_H
@@ -0,0 +1,35 @@
+/*
+ * Host test taklidi: FreeRTOS özyinelemeli mutex (pthread)
+ */
+#ifndef STUB_FREERTOS_SEMPHR_H
+#define STUB_FREERTOS_SEMPHR_H
+
+#include <pthread.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+
+typedef pthread_mutex_t *SemaphoreHandle_t;
+
+static inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void) {
+    pthread_mutexattr_t attr;
+    SemaphoreHandle_t m = malloc(sizeof(*m));
+    if (m == NULL) {
+        return NULL;
+    }
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(m, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return m;
+}
+
+// Sadece portMAX_DELAY ile kullanılır: süre yok sayılır
+static inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t m, TickType_t ticks) {
+    return pthread_mutex_lock(m) == 0 ? pdTRUE : pdFALSE;
+}
+
+static inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t m) {
+    return pthread_mutex_unlock(m) == 0 ? pdTRUE : pdFALSE;
+}
+
+#endif // STUB_FREERTOS_SEMPHR_H
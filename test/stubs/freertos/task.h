@@ -0,0 +1,18 @@
+/*
+ * Host test taklidi: FreeRTOS task API (vTaskDelay → nanosleep)
+ */
+#ifndef STUB_FREERTOS_TASK_H
+#define STUB_FREERTOS_TASK_H
+
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+
+typedef struct tskTaskControlBlock *TaskHandle_t;
+
+static inline void vTaskDelay(TickType_t ticks) {
+    uint64_t ns = (uint64_t)ticks * portTICK_PERIOD_MS * 1000000ULL;
+    struct timespec ts = { (time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL) };
+    nanosleep(&ts, NULL);
+}
+
+#endif // STUB_FREERTOS_TASK_H
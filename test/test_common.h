@@ -0,0 +1,44 @@
+/*
+ * KlimasanAndonV2 - Host test yardımcıları
+ * Bağımlılıksız küçük assert seti: başarısız kontrol dosya/satır ile yazılır,
+ * test sonunda TEST_DONE hata varsa 1 ile çıkar (ctest başarısız sayar).
+ */
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+static int s_test_failures __attribute__((unused)) = 0;
+static int s_test_checks __attribute__((unused)) = 0;
+
+#define TEST_CHECK(cond, ...)                                                  \
+    do {                                                                       \
+        s_test_checks++;                                                       \
+        if (!(cond)) {                                                         \
+            s_test_failures++;                                                 \
+            printf("FAIL %s:%d: %s: ", __FILE__, __LINE__, #cond);             \
+            printf(__VA_ARGS__);                                               \
+            printf("\n");                                                      \
+        }                                                                      \
+    } while (0)
+
+#define TEST_CHECK_EQ(actual, expected, what)                                  \
+    TEST_CHECK((long long)(actual) == (long long)(expected), "%s = %lld, beklenen %lld", \
+               (what), (long long)(actual), (long long)(expected))
+
+#define TEST_DONE()                                                            \
+    do {                                                                       \
+        printf("%d kontrol, %d hata\n", s_test_checks, s_test_failures);       \
+        return s_test_failures ? 1 : 0;                                        \
+    } while (0)
+
+// Monotonik zaman (ns): benchmark ve gecikme ölçümleri
+static inline uint64_t test_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+#endif // TEST_COMMON_H
@@ -0,0 +1,132 @@
+/*
+ * KlimasanAndonV2 - Display dalga formu testleri (host)
+ * Bir frame derlenir ve her latch adımının kelimesi (BCD / LD / HC138 bit
+ * düzeni), frame uzunluğu ve I2S saat bölücülerinin tarama periyoduyla
+ * uyumu kontrol edilir.
+ */
+#include <stdio.h>
+
+#include "andon_display.h"
+#include "display_waveform.h"
+#include "test_common.h"
+
+#define HANE_MASK   (0x07U << DISPLAY_WAVE_BIT_A0)
+#define LD_MASK     (0xFFU << DISPLAY_WAVE_BIT_LD1)
+
+static uint16_t expect_word(uint8_t bcd, int hane, int ld) {
+    uint16_t w = (uint16_t)(((bcd & 0x0F) << DISPLAY_WAVE_BIT_D0) | ((hane & 0x07) << DISPLAY_WAVE_BIT_A0));
+    if (ld >= 0) {
+        w |= (uint16_t)(1U << (DISPLAY_WAVE_BIT_LD1 + ld));
+    }
+    return w;
+}
+
+// Tarama/latch başına farklı değer; her taramada bir blank (0x0F)
+static void fill_scan_data(uint8_t scan_data[6][8]) {
+    for (int scan = 0; scan < 6; scan++) {
+        for (int latch = 0; latch < 8; latch++) {
+            scan_data[scan][latch] = (uint8_t)((scan * 3 + latch) % 10);
+        }
+        scan_data[scan][scan] = DISPLAY_BLANK;
+    }
+}
+
+static void test_frame_length(void) {
+    TEST_CHECK_EQ(DISPLAY_WAVE_SCAN_SAMPLES, 8 * 3 + 120, "tarama başına örnek");
+    TEST_CHECK_EQ(DISPLAY_WAVE_FRAME_SAMPLES, 864, "frame başına örnek");
+    TEST_CHECK(DISPLAY_WAVE_FRAME_SAMPLES * 2 <= 4095, "frame tek DMA descriptor'a sığmalı (%d bayt)",
+               DISPLAY_WAVE_FRAME_SAMPLES * 2);
+}
+
+static void test_latch_words(void) {
+    static uint16_t out[DISPLAY_WAVE_FRAME_SAMPLES + 1];
+    uint8_t scan_data[6][8];
+    fill_scan_data(scan_data);
+    out[DISPLAY_WAVE_FRAME_SAMPLES] = 0xBEEF;   // Taşma bekçisi
+    display_waveform_compile(scan_data, true, false, out);
+
+    TEST_CHECK(out[DISPLAY_WAVE_FRAME_SAMPLES] == 0xBEEF, "derleyici frame sonrasına yazdı");
+    for (int scan = 0; scan < 6; scan++) {
+        const uint16_t *s = &out[scan * DISPLAY_WAVE_SCAN_SAMPLES];
+        for (int latch = 0; latch < 8; latch++) {
+            const uint16_t *l = &s[latch * DISPLAY_WAVE_LATCH_SAMPLES];
+            uint8_t bcd = scan_data[scan][latch];
+            // Data kurulum, LD HIGH, LD LOW; HC138 = 7 (tüm haneler kapalı)
+            TEST_CHECK(l[0] == expect_word(bcd, DISPLAY_WAVE_HANE_OFF, -1),
+                       "tarama %d latch %d kurulum: 0x%04X", scan, latch, l[0]);
+            TEST_CHECK(l[1] == expect_word(bcd, DISPLAY_WAVE_HANE_OFF, latch),
+                       "tarama %d latch %d strobe: 0x%04X", scan, latch, l[1]);
+            TEST_CHECK(l[2] == expect_word(bcd, DISPLAY_WAVE_HANE_OFF, -1),
+                       "tarama %d latch %d bırakma: 0x%04X", scan, latch, l[2]);
+        }
+        // Bekleme: son latch'in BCD'si sabit, hane seçili, LD yok
+        uint16_t dwell = expect_word(scan_data[scan][7], scan, -1);
+        int bad = 0;
+        for (int i = 8 * DISPLAY_WAVE_LATCH_SAMPLES; i < DISPLAY_WAVE_SCAN_SAMPLES; i++) {
+            bad += (s[i] != dwell);
+        }
+        TEST_CHECK(bad == 0, "tarama %d: %d bekleme örneği 0x%04X değil", scan, bad, dwell);
+    }
+
+    // Kullanılmayan bit 15 hiç set edilmez; her örnekte en fazla bir LD
+    int high_bit = 0, multi_ld = 0;
+    for (int i = 0; i < DISPLAY_WAVE_FRAME_SAMPLES; i++) {
+        uint16_t ld = out[i] & LD_MASK;
+        high_bit += (out[i] >> DISPLAY_WAVE_NUM_BITS) != 0;
+        multi_ld += (ld & (ld - 1)) != 0;
+    }
+    TEST_CHECK_EQ(high_bit, 0, "bit 15 set edilen örnek");
+    TEST_CHECK_EQ(multi_ld, 0, "birden fazla LD strobe'lu örnek");
+}
+
+static void test_screen_off(void) {
+    static uint16_t out[DISPLAY_WAVE_FRAME_SAMPLES];
+    uint8_t scan_data[6][8];
+    fill_scan_data(scan_data);
+    display_waveform_compile(scan_data, false, false, out);
+
+    int lit = 0;
+    for (int i = 0; i < DISPLAY_WAVE_FRAME_SAMPLES; i++) {
+        lit += ((out[i] & HANE_MASK) >> DISPLAY_WAVE_BIT_A0) != DISPLAY_WAVE_HANE_OFF;
+    }
+    TEST_CHECK_EQ(lit, 0, "ekran kapalıyken hane seçili örnek");
+}
+
+// ESP32 I2S 16-bit modu örnek çiftlerini ters çıkarır: derleyici önceden takas eder
+static void test_swap_pairs(void) {
+    static uint16_t plain[DISPLAY_WAVE_FRAME_SAMPLES], swapped[DISPLAY_WAVE_FRAME_SAMPLES];
+    uint8_t scan_data[6][8];
+    fill_scan_data(scan_data);
+    display_waveform_compile(scan_data, true, false, plain);
+    display_waveform_compile(scan_data, true, true, swapped);
+
+    int bad = 0;
+    for (int i = 0; i < DISPLAY_WAVE_FRAME_SAMPLES; i++) {
+        bad += swapped[i] != plain[i ^ 1];
+    }
+    TEST_CHECK_EQ(bad, 0, "çift takası hatalı örnek");
+}
+
+// Bölücü matematiği: örnek hızı → tarama ve frame süresi → refresh
+static void test_i2s_clock(void) {
+    unsigned long sample_hz = DISPLAY_WAVE_I2S_SRC_HZ /
+                              (DISPLAY_WAVE_I2S_CLKM_DIV * DISPLAY_WAVE_I2S_BCK_DIV * 2UL);
+    TEST_CHECK_EQ(sample_hz, 100000, "I2S örnek hızı (Hz)");
+    TEST_CHECK_EQ(1000000UL / sample_hz, DISPLAY_WAVE_SAMPLE_US, "örnek süresi (us)");
+    TEST_CHECK_EQ(DISPLAY_WAVE_SCAN_SAMPLES * 1000000UL / sample_hz, DISPLAY_SCAN_PERIOD_US,
+                  "I2S tarama süresi vs DISPLAY_SCAN_PERIOD_US (us)");
+
+    unsigned long frame_us = DISPLAY_WAVE_FRAME_SAMPLES * 1000000UL / sample_hz;
+    TEST_CHECK_EQ(frame_us, 6UL * DISPLAY_SCAN_PERIOD_US, "frame süresi (us)");
+    printf("I2S: %lu Hz örnek, %d us/tarama, %lu us/frame, refresh %.2f Hz\n", sample_hz,
+           DISPLAY_SCAN_PERIOD_US, frame_us, 1e6 / (double)frame_us);
+}
+
+int main(void) {
+    test_frame_length();
+    test_latch_words();
+    test_screen_off();
+    test_swap_pairs();
+    test_i2s_clock();
+    TEST_DONE();
+}
@@ -0,0 +1,203 @@
+/*
+ * KlimasanAndonV2 - IR çözücü birim testleri (host)
+ * Her protokol için geçerli çerçeve, NEC repeat ve pencere dışı darbe reddi.
+ * Darbe dizileri ir_synth.h ile üretilir ve ir_decoder_replay ile çözülür.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "ir_decoder.h"
+#include "ir_synth.h"
+#include "test_common.h"
+
+#define MAX_FRAMES  4
+
+// ============ Geçerli Çerçeveler ============
+typedef enum {
+    GEN_NEC,
+    GEN_NEC_REPEAT,     // Tam çerçeve + repeat kodu
+    GEN_SAMSUNG,
+    GEN_RC5,
+    GEN_SIRC,
+} gen_kind_t;
+
+typedef struct {
+    const char *name;
+    gen_kind_t kind;
+    uint8_t bytes[4];       // NEC/Samsung ham baytlar (iletim sırası)
+    uint8_t toggle;         // RC5
+    uint16_t address;       // RC5/SIRC üretim parametresi
+    uint8_t command;
+    int sirc_bits;
+    // Beklenen
+    ir_protocol_t protocol;
+    uint16_t exp_address;
+    uint8_t exp_command;
+} valid_case_t;
+
+// Standart NEC eski anahtar düzeni: address = ~command baytı, command = ~address baytı
+static const valid_case_t s_valid[] = {
+    { "NEC",        GEN_NEC,        { 0x00, 0xFF, 0x11, 0xEE }, 0, 0, 0, 0,   IR_PROTO_NEC,     0x00EE, 0xFF },
+    { "NEC-EXT",    GEN_NEC,        { 0x12, 0x34, 0x45, 0xBA }, 0, 0, 0, 0,   IR_PROTO_NEC_EXT, 0x3412, 0x45 },
+    { "SAMSUNG",    GEN_SAMSUNG,    { 0x07, 0x07, 0x02, 0xFD }, 0, 0, 0, 0,   IR_PROTO_SAMSUNG, 0x0007, 0x02 },
+    { "RC5",        GEN_RC5,        { 0 }, 1, 0x05, 0x35, 0,                  IR_PROTO_RC5,     0x0005, 0x35 },
+    { "RC5 sıfır",  GEN_RC5,        { 0 }, 0, 0x00, 0x00, 0,                  IR_PROTO_RC5,     0x0000, 0x00 },
+    { "RC5X",       GEN_RC5,        { 0 }, 0, 0x03, 0x41, 0,                  IR_PROTO_RC5,     0x0003, 0x41 },
+    { "SIRC12",     GEN_SIRC,       { 0 }, 0, 0x01, 0x15, 12,                 IR_PROTO_SIRC,    0x0001, 0x15 },
+    { "SIRC15",     GEN_SIRC,       { 0 }, 0, 0x9A, 0x22, 15,                 IR_PROTO_SIRC,    0x009A, 0x22 },
+    { "SIRC20",     GEN_SIRC,       { 0 }, 0, 0x1ABC, 0x7F, 20,               IR_PROTO_SIRC,    0x1ABC, 0x7F },
+};
+
+static void gen_valid(const valid_case_t *c, ir_synth_t *s) {
+    memset(s, 0, sizeof(*s));
+    switch (c->kind) {
+        case GEN_NEC:        ir_synth_nec(s, c->bytes); break;
+        case GEN_NEC_REPEAT: ir_synth_nec(s, c->bytes); ir_synth_nec_repeat(s); break;
+        case GEN_SAMSUNG:    ir_synth_samsung(s, c->bytes); break;
+        case GEN_RC5:        ir_synth_rc5(s, ir_synth_rc5_bits(c->toggle, (uint8_t)c->address, c->command)); break;
+        case GEN_SIRC:       ir_synth_sirc(s, c->command, c->address, c->sirc_bits); break;
+    }
+}
+
+static void test_valid_frames(void) {
+    for (size_t i = 0; i < sizeof(s_valid) / sizeof(s_valid[0]); i++) {
+        const valid_case_t *c = &s_valid[i];
+        ir_synth_t s;
+        ir_decoder_t dec = { 0 };
+        ir_frame_t frames[MAX_FRAMES];
+        gen_valid(c, &s);
+
+        size_t n = ir_decoder_replay(&dec, s.p, s.n, frames, MAX_FRAMES);
+        TEST_CHECK(n == 1, "%s: %zu çerçeve", c->name, n);
+        if (n < 1) continue;
+        TEST_CHECK(frames[0].protocol == c->protocol, "%s: protokol %s", c->name,
+                   ir_decoder_protocol_name(frames[0].protocol));
+        TEST_CHECK(frames[0].address == c->exp_address, "%s: adres 0x%04X", c->name, frames[0].address);
+        TEST_CHECK(frames[0].command == c->exp_command, "%s: komut 0x%02X", c->name, frames[0].command);
+        TEST_CHECK(!frames[0].repeat, "%s: repeat işaretli", c->name);
+        if (c->kind == GEN_RC5) {
+            TEST_CHECK(frames[0].toggle == c->toggle, "%s: toggle %u", c->name, frames[0].toggle);
+        }
+        TEST_CHECK(dec.errors == 0, "%s: %u hata", c->name, (unsigned)dec.errors);
+    }
+}
+
+// ============ Repeat ============
+static void test_nec_repeat(void) {
+    static const uint8_t bytes[4] = { 0x00, 0xFF, 0x11, 0xEE };
+    ir_synth_t s = { 0 };
+    ir_decoder_t dec = { 0 };
+    ir_frame_t frames[MAX_FRAMES];
+
+    ir_synth_nec(&s, bytes);
+    ir_synth_nec_repeat(&s);
+    ir_synth_nec_repeat(&s);
+    size_t n = ir_decoder_replay(&dec, s.p, s.n, frames, MAX_FRAMES);
+    TEST_CHECK_EQ(n, 3, "NEC + 2 repeat çerçeve sayısı");
+    if (n != 3) return;
+    TEST_CHECK(!frames[0].repeat && frames[0].address == 0x00EE, "ilk çerçeve tam kod olmalı");
+    TEST_CHECK(frames[1].repeat && frames[1].protocol == IR_PROTO_NEC, "ikinci çerçeve NEC repeat olmalı");
+    TEST_CHECK(frames[2].repeat, "üçüncü çerçeve NEC repeat olmalı");
+}
+
+// Repeat kodu bitiş mark'ı olmadan (gürültüdeki 9ms + 2.25ms) kabul edilmemeli
+static void test_nec_repeat_needs_stop_mark(void) {
+    static const int32_t no_stop[] = { 9000, -2250 };
+    static const int32_t bad_stop[] = { 9000, -2250, (int32_t)IR_PD_BIT_MARK_MAX + 1 };
+    ir_decoder_t dec = { 0 };
+    ir_frame_t frames[MAX_FRAMES];
+
+    TEST_CHECK_EQ(ir_decoder_replay(&dec, no_stop, 2, frames, MAX_FRAMES), 0, "bitiş mark'sız repeat");
+    TEST_CHECK_EQ(ir_decoder_replay(&dec, bad_stop, 3, frames, MAX_FRAMES), 0, "pencere dışı bitiş mark'lı repeat");
+}
+
+// ============ Pencere Dışı Darbeler ============
+// Geçerli bir çerçevenin tek darbesi pencerenin hemen dışına çekilir: çözücü
+// hiçbir protokolde çerçeve üretmemeli. Sınır değerin kendisi kabul edilmeli.
+typedef struct {
+    const char *name;
+    size_t base;            // s_valid indeksi
+    size_t pulse;           // Değiştirilen darbe
+    uint32_t duration_us;   // Yeni süre (işaret darbe tipinden gelir)
+    size_t expect_frames;
+} window_case_t;
+
+static const window_case_t s_window[] = {
+    // NEC leader mark [IR_NEC_LEADER_MARK_MIN, MAX]
+    { "NEC leader mark min",        0, 0, IR_NEC_LEADER_MARK_MIN,       1 },
+    { "NEC leader mark min-1",      0, 0, IR_NEC_LEADER_MARK_MIN - 1,   0 },
+    { "NEC leader mark max",        0, 0, IR_NEC_LEADER_MARK_MAX,       1 },
+    { "NEC leader mark max+1",      0, 0, IR_NEC_LEADER_MARK_MAX + 1,   0 },
+    // Leader space ve bit darbeleri
+    { "NEC leader space min-1",     0, 1, IR_PD_LEADER_SPACE_MIN - 1,   0 },
+    { "NEC bit mark max+1",         0, 2, IR_PD_BIT_MARK_MAX + 1,       0 },
+    { "NEC bit mark min-1",         0, 2, IR_PD_BIT_MARK_MIN - 1,       0 },
+    { "NEC bit space max+1",        0, 3, IR_PD_BIT_SPACE_MAX + 1,      0 },
+    { "NEC bit space min-1",        0, 3, IR_PD_BIT_SPACE_MIN - 1,      0 },
+    // Samsung leader mark
+    { "SAMSUNG leader mark min-1",  2, 0, IR_SAMSUNG_LEADER_MARK_MIN - 1, 0 },
+    { "SAMSUNG leader mark max+1",  2, 0, IR_SAMSUNG_LEADER_MARK_MAX + 1, 0 },
+    // RC5: yarım ve tam bit arasındaki boşluk
+    { "RC5 yarım max+1",            3, 1, IR_RC5_HALF_MAX + 1,          0 },
+    { "RC5 tam min-1",              3, 1, IR_RC5_FULL_MIN - 1,          0 },
+    // SIRC leader ve 0/1 mark arası
+    { "SIRC leader max+1",          6, 0, IR_SIRC_LEADER_MARK_MAX + 1,  0 },
+    { "SIRC mark 0/1 arası",        6, 2, IR_SIRC_MARK0_MAX + 1,        0 },
+    { "SIRC space max+1",           6, 1, IR_SIRC_SPACE_MAX + 1,        0 },
+};
+
+static void test_out_of_window(void) {
+    for (size_t i = 0; i < sizeof(s_window) / sizeof(s_window[0]); i++) {
+        const window_case_t *c = &s_window[i];
+        ir_synth_t s;
+        ir_decoder_t dec = { 0 };
+        ir_frame_t frames[MAX_FRAMES];
+        gen_valid(&s_valid[c->base], &s);
+
+        if (c->pulse >= s.n) {
+            TEST_CHECK(0, "%s: darbe indeksi %zu dizi dışında", c->name, c->pulse);
+            continue;
+        }
+        s.p[c->pulse] = s.p[c->pulse] > 0 ? (int32_t)c->duration_us : -(int32_t)c->duration_us;
+        size_t n = ir_decoder_replay(&dec, s.p, s.n, frames, MAX_FRAMES);
+        TEST_CHECK(n == c->expect_frames, "%s: %zu çerçeve (beklenen %zu)%s%s", c->name, n,
+                   c->expect_frames, n ? ", ilk: " : "", n ? ir_decoder_protocol_name(frames[0].protocol) : "");
+    }
+}
+
+// Bozuk çerçeveden sonra çözücü bir sonraki çerçeveyi kaçırmamalı
+static void test_recovery_after_reject(void) {
+    ir_synth_t s;
+    ir_decoder_t dec = { 0 };
+    ir_frame_t frames[MAX_FRAMES];
+
+    gen_valid(&s_valid[0], &s);
+    s.p[10] = -(int32_t)(IR_PD_BIT_SPACE_MAX + 500);   // Çerçeve ortasında bozuk space
+    ir_synth_nec(&s, s_valid[0].bytes);
+    size_t n = ir_decoder_replay(&dec, s.p, s.n, frames, MAX_FRAMES);
+    TEST_CHECK_EQ(n, 1, "bozuk + geçerli NEC çerçeve sayısı");
+    TEST_CHECK(n == 1 && frames[0].address == 0x00EE, "geçerli çerçeve çözülmeli");
+}
+
+// Checksum hatası çerçeve üretmez, hata sayacını artırır
+static void test_checksum_error(void) {
+    static const uint8_t bad[4] = { 0x00, 0xFF, 0x11, 0xEF };
+    ir_synth_t s = { 0 };
+    ir_decoder_t dec = { 0 };
+    ir_frame_t frames[MAX_FRAMES];
+
+    ir_synth_nec(&s, bad);
+    size_t n = ir_decoder_replay(&dec, s.p, s.n, frames, MAX_FRAMES);
+    TEST_CHECK_EQ(n, 0, "checksum hatalı NEC çerçeve sayısı");
+    TEST_CHECK_EQ(dec.errors, 1, "checksum hata sayacı");
+}
+
+int main(void) {
+    test_valid_frames();
+    test_nec_repeat();
+    test_nec_repeat_needs_stop_mark();
+    test_out_of_window();
+    test_recovery_after_reject();
+    test_checksum_error();
+    TEST_DONE();
+}
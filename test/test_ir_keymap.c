@@ -0,0 +1,266 @@
+/*
+ * KlimasanAndonV2 - IR tuş haritası testleri (host)
+ * Öğrenme, yeniden bağlama ve kayıt (flush) akışı. NVS, RAM'de tutulan
+ * sahte bir blob ile taklit edilir; "yeniden başlatma" ir_keymap_init'tir.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "ir_keymap.h"
+#include "nvs_storage.h"
+#include "test_common.h"
+
+// ============ NVS Taklidi ============
+static uint8_t s_flash[512];
+static size_t s_flash_len = 0;      // 0 = anahtar yok
+static int s_flash_saves = 0;
+
+void nvs_storage_save_ir_keymap(const void *blob, size_t len) {
+    if (len > sizeof(s_flash)) {
+        len = sizeof(s_flash);
+    }
+    memcpy(s_flash, blob, len);
+    s_flash_len = len;
+    s_flash_saves++;
+}
+
+size_t nvs_storage_load_ir_keymap(void *blob, size_t max_len) {
+    if (s_flash_len == 0 || s_flash_len > max_len) {
+        return 0;
+    }
+    memcpy(blob, s_flash, s_flash_len);
+    return s_flash_len;
+}
+
+static void flash_erase(void) {
+    memset(s_flash, 0, sizeof(s_flash));
+    s_flash_len = 0;
+    s_flash_saves = 0;
+}
+
+// Güç kesildi: RAM tablosu NVS'den yeniden kurulur
+static void reboot(void) {
+    ir_keymap_init();
+}
+
+// Öğrenmede o anki aksiyonu hedefe kadar atla
+static void learn_skip_to(ir_action_t action) {
+    while (ir_keymap_is_learning() && ir_keymap_learn_action() < action) {
+        ir_keymap_learn_skip();
+    }
+}
+
+// ============ Testler ============
+
+static void test_defaults(void) {
+    flash_erase();
+    reboot();
+    TEST_CHECK_EQ(ir_keymap_lookup(IR_PROTO_NEC, 0xEF, 0x42), IR_ACTION_DIGIT_0, "NEC adres joker");
+    TEST_CHECK_EQ(ir_keymap_lookup(IR_PROTO_NEC, 0xFF, 0x1D), IR_ACTION_POWER, "NEC tam eşleşme");
+    TEST_CHECK_EQ(ir_keymap_lookup(IR_PROTO_SAMSUNG, 0xEF, 0x42), IR_ACTION_NONE, "joker sadece NEC");
+    TEST_CHECK(!ir_keymap_flush(), "açılışta bekleyen kayıt olmamalı");
+    TEST_CHECK_EQ(s_flash_saves, 0, "açılışta NVS yazımı");
+}
+
+static void test_learn_new_and_flush(void) {
+    flash_erase();
+    reboot();
+    ir_keymap_learn_start();
+    TEST_CHECK_EQ(ir_keymap_learn_action(), IR_ACTION_DIGIT_0, "ilk beklenen aksiyon");
+    TEST_CHECK(!ir_keymap_learn_code(IR_PROTO_SAMSUNG, 0x0707, 0x02), "ilk kodda öğrenme bitmemeli");
+    TEST_CHECK_EQ(ir_keymap_learn_action(), IR_ACTION_DIGIT_1, "sonraki aksiyon");
+    TEST_CHECK_EQ(ir_keymap_lookup(IR_PROTO_SAMSUNG, 0x0707, 0x02), IR_ACTION_DIGIT_0, "RAM'de bağlı");
+
+    // Kayıt finish'e kadar işaretlenmez, flush'a kadar yazılmaz
+    TEST_CHECK(!ir_keymap_flush(), "öğrenme sürerken kayıt");
+    ir_keymap_learn_finish();
+    TEST_CHECK_EQ(s_flash_saves, 0, "finish yazım bölümünde NVS'ye yazmamalı");
+    TEST_CHECK(ir_keymap_flush(), "finish sonrası kayıt bekliyor");
+    TEST_CHECK_EQ(s_flash_saves, 1, "flush sonrası NVS yazımı");
+    TEST_CHECK(!ir_keymap_flush(), "ikinci flush boş olmalı");
+
+    reboot();
+    TEST_CHECK_EQ(ir_keymap_lookup(IR_PROTO_SAMSUNG, 0x0707, 0x02), IR_ACTION_DIGIT_0,
+                  "yeniden başlatma sonrası öğrenilen kod");
+}
+
+// Sadece önceki oturumdan bir kodu yeniden öğreten oturum da kaydedilmeli
+static void test_rebind_persists(void) {
+    flash_erase();
+    reboot();
+    ir_keymap_learn_start();
+    ir_keymap_learn_code(IR_PROTO_RC5, 0x0005, 0x0C);          // → DIGIT_0
+    ir_keymap_learn_finish();
+    ir_keymap_flush();
+    int saves = s_flash_saves;
+
+    reboot();
+    ir_keymap_learn_start();
+    learn_skip_to(IR_ACTION_POWER);
+    ir_keymap_learn_code(IR_PROTO_RC5, 0x0005, 0x0C);          // Aynı kod → POWER
+    TEST_CHECK_EQ(ir_keymap_lookup(IR_PROTO_RC5, 0x0005, 0x0C), IR_ACTION_POWER, "RAM'de yeniden bağlı");
+    ir_keymap_learn_finish();
+    TEST_CHECK(ir_keymap_flush(), "yeniden bağlama kayda işaretlenmeli");
+    TEST_CHECK_EQ(s_flash_saves, saves + 1, "yeniden bağlama NVS yazımı");
+
+    reboot();
+    TEST_CHECK_EQ(ir_keymap_lookup(IR_PROTO_RC5, 0x0005, 0x0C), IR_ACTION_POWER,
+                  "yeniden başlatma sonrası yeniden bağlanan kod");
+}
+
+// Hiçbir kod bağlanmayan oturum (sadece atlama) flash'a yazmaz
+static void test_empty_session_no_save(void) {
+    flash_erase();
+    reboot();
+    ir_keymap_learn_start();
+    ir_keymap_learn_skip();
+    ir_keymap_learn_skip();
+    ir_keymap_learn_finish();
+    TEST_CHECK(!ir_keymap_flush(), "boş oturum kayıt işaretlememeli");
+
+    // Bağlama yapılıp kaydedilen oturumdan sonra boş oturum eski bayrağı taşımaz
+    ir_keymap_learn_start();
+    ir_keymap_learn_code(IR_PROTO_SIRC, 0x01, 0x15);
+    ir_keymap_learn_finish();
+    ir_keymap_flush();
+    ir_keymap_learn_start();
+    ir_keymap_learn_finish();
+    TEST_CHECK(!ir_keymap_flush(), "önceki oturumun bayrağı taşındı");
+}
+
+// Aynı oturumda aynı tuş ikinci aksiyona bağlanmaz
+static void test_same_session_duplicate(void) {
+    flash_erase();
+    reboot();
+    ir_keymap_learn_start();
+    ir_keymap_learn_code(IR_PROTO_NEC_EXT, 0x1234, 0x40);      // → DIGIT_0
+    TEST_CHECK(!ir_keymap_learn_code(IR_PROTO_NEC_EXT, 0x1234, 0x40), "tekrar basış reddedilmeli");
+    TEST_CHECK_EQ(ir_keymap_learn_action(), IR_ACTION_DIGIT_1, "tekrar basış aksiyonu ilerletmemeli");
+    TEST_CHECK_EQ(ir_keymap_lookup(IR_PROTO_NEC_EXT, 0x1234, 0x40), IR_ACTION_DIGIT_0, "ilk bağlama korunur");
+    ir_keymap_learn_finish();
+}
+
+// Öğrenilen kod varsayılanı ezer
+static void test_learned_overrides_default(void) {
+    flash_erase();
+    reboot();
+    ir_keymap_learn_start();
+    ir_keymap_learn_code(IR_PROTO_NEC, 0xFF, 0x07);            // Varsayılan DIGIT_1 → DIGIT_0
+    ir_keymap_learn_finish();
+    ir_keymap_flush();
+    reboot();
+    TEST_CHECK_EQ(ir_keymap_lookup(IR_PROTO_NEC, 0xFF, 0x07), IR_ACTION_DIGIT_0, "öğrenilen varsayılanı ezer");
+    TEST_CHECK_EQ(ir_keymap_lookup(IR_PROTO_NEC, 0xFF, 0x15), IR_ACTION_DIGIT_2, "diğer varsayılanlar korunur");
+}
+
+// Son aksiyon bağlanınca öğrenme kendiliğinden biter ve kayda işaretlenir
+static void test_full_session_autofinish(void) {
+    flash_erase();
+    reboot();
+    ir_keymap_learn_start();
+    bool done = false;
+    int bound = 0;
+    for (uint8_t cmd = 0; !done && cmd < IR_ACTION_COUNT; cmd++) {
+        done = ir_keymap_learn_code(IR_PROTO_SAMSUNG, 0x0E0E, cmd);
+        bound++;
+    }
+    TEST_CHECK(done, "son aksiyonda öğrenme bitmeli");
+    TEST_CHECK_EQ(bound, IR_ACTION_COUNT - 1, "bağlanan aksiyon");
+    TEST_CHECK(!ir_keymap_is_learning(), "öğrenme kapanmalı");
+    TEST_CHECK(ir_keymap_flush(), "otomatik bitiş kayda işaretlemeli");
+    reboot();
+    TEST_CHECK_EQ(ir_keymap_lookup(IR_PROTO_SAMSUNG, 0x0E0E, IR_ACTION_COUNT - 2), IR_ACTION_OK,
+                  "son aksiyon yeniden başlatma sonrası");
+}
+
+// Tablo dolunca yeni kod reddedilir, eski koda yeniden bağlama çalışır
+static void test_table_full(void) {
+    flash_erase();
+    reboot();
+    int learned = 0;
+    uint8_t cmd = 0;
+    while (learned < IR_KEYMAP_LEARN_MAX) {
+        ir_keymap_learn_start();
+        while (ir_keymap_is_learning() && learned < IR_KEYMAP_LEARN_MAX) {
+            ir_keymap_learn_code(IR_PROTO_SIRC, 0x1A, cmd++);
+            learned++;
+        }
+        ir_keymap_learn_finish();
+    }
+    ir_keymap_learn_start();
+    ir_action_t before = ir_keymap_learn_action();
+    TEST_CHECK(!ir_keymap_learn_code(IR_PROTO_SIRC, 0x1A, cmd), "dolu tabloda yeni kod reddedilmeli");
+    TEST_CHECK_EQ(ir_keymap_learn_action(), before, "red aksiyonu ilerletmemeli");
+    ir_keymap_learn_code(IR_PROTO_SIRC, 0x1A, 0);              // Eski koda yeniden bağla
+    TEST_CHECK_EQ(ir_keymap_lookup(IR_PROTO_SIRC, 0x1A, 0), before, "dolu tabloda yeniden bağlama");
+    ir_keymap_learn_finish();
+    TEST_CHECK(ir_keymap_flush(), "dolu tabloda yeniden bağlama kaydı");
+}
+
+static void test_reset(void) {
+    flash_erase();
+    reboot();
+    ir_keymap_learn_start();
+    ir_keymap_learn_code(IR_PROTO_RC5, 0x0010, 0x01);
+    ir_keymap_learn_finish();
+    ir_keymap_flush();
+
+    ir_keymap_reset();
+    TEST_CHECK_EQ(ir_keymap_lookup(IR_PROTO_RC5, 0x0010, 0x01), IR_ACTION_NONE, "reset RAM'den siler");
+    TEST_CHECK(ir_keymap_flush(), "reset kayda işaretlemeli");
+    reboot();
+    TEST_CHECK_EQ(ir_keymap_lookup(IR_PROTO_RC5, 0x0010, 0x01), IR_ACTION_NONE, "reset kalıcı");
+    TEST_CHECK_EQ(ir_keymap_lookup(IR_PROTO_NEC, 0xFF, 0x1D), IR_ACTION_POWER, "reset sonrası varsayılanlar");
+}
+
+// v1 blob (sadece NEC, 8 bit adres) açılışta v2'ye çevrilip hemen yazılır
+static void test_v1_migration(void) {
+    struct {
+        uint8_t version, count, reserved[2];
+        struct { uint8_t address, command, action, reserved; } entries[IR_KEYMAP_LEARN_MAX];
+    } v1;
+    memset(&v1, 0, sizeof(v1));
+    v1.version = 1;
+    v1.count = 2;
+    v1.entries[0].address = 0x33; v1.entries[0].command = 0x44; v1.entries[0].action = IR_ACTION_MENU;
+    v1.entries[1].address = 0x33; v1.entries[1].command = 0x45; v1.entries[1].action = 0xEE;   // Bozuk
+
+    flash_erase();
+    nvs_storage_save_ir_keymap(&v1, sizeof(v1));
+    s_flash_saves = 0;
+    reboot();
+    TEST_CHECK_EQ(s_flash_saves, 1, "göç sonrası kayıt");
+    TEST_CHECK(s_flash_len != sizeof(v1), "göç sonrası blob v2 boyunda olmalı");
+    TEST_CHECK_EQ(ir_keymap_lookup(IR_PROTO_NEC, 0x33, 0x44), IR_ACTION_MENU, "göç edilen kod");
+    TEST_CHECK_EQ(ir_keymap_lookup(IR_PROTO_NEC, 0x33, 0x45), IR_ACTION_NONE, "bozuk kayıt atılır");
+
+    s_flash_saves = 0;
+    reboot();
+    TEST_CHECK_EQ(s_flash_saves, 0, "v2 blob tekrar yazılmamalı");
+    TEST_CHECK_EQ(ir_keymap_lookup(IR_PROTO_NEC, 0x33, 0x44), IR_ACTION_MENU, "v2 blob yeniden yükleme");
+}
+
+static void test_corrupt_blob(void) {
+    uint8_t junk[40];
+    memset(junk, 0xA5, sizeof(junk));
+    flash_erase();
+    nvs_storage_save_ir_keymap(junk, sizeof(junk));
+    reboot();
+    TEST_CHECK_EQ(ir_keymap_lookup(IR_PROTO_NEC, 0xFF, 0x1D), IR_ACTION_POWER, "bozuk blob: varsayılanlar");
+    TEST_CHECK(!ir_keymap_flush(), "bozuk blob kayıt işaretlememeli");
+}
+
+int main(void) {
+    test_defaults();
+    test_learn_new_and_flush();
+    test_rebind_persists();
+    test_empty_session_no_save();
+    test_same_session_duplicate();
+    test_learned_overrides_default();
+    test_full_session_autofinish();
+    test_table_full();
+    test_reset();
+    test_v1_migration();
+    test_corrupt_blob();
+    TEST_DONE();
+}
@@ -0,0 +1,490 @@
+/*
+ * KlimasanAndonV2 - Seqlock stres testi (host, pthread)
+ * Bir yazar, N okuyucu: sys_data_snapshot ve time_accounting_get_at hiçbir
+ * zaman iki farklı yazımın alanlarını karıştırmamalı. Okuma ve yazım bölümü
+ * gecikmeleri raporlanır.
+ *
+ * Sayaçlar: K iş parçacığı gerçekleşen adede M kez 1 ekler (toplam K*M olmalı);
+ * cycle sayacı K iş parçacığından ilerletilirken ayrı bir iş parçacığı
+ * sıfırlar (artış kaybolmamalı, değer geri gitmemeli).
+ *
+ *   test_seqlock_stress [süre_ms] [okuyucu_sayısı]
+ *
+ * Yazar i. yazımda her alana i'den türetilen bir değer yazar; okuyucu kopyadaki
+ * i'den diğer alanları yeniden hesaplar. Yazar bölüm ortasında ara sıra
+ * işlemciyi bırakır (FreeRTOS'ta düşük öncelikli yazarın kesilmesi gibi):
+ * korumasız kopya (kontrol) bu anlarda yırtılır, seqlock'lu kopya yırtılmamalı.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cycle_counter.h"
+#include "system_state.h"
+#include "time_accounting.h"
+#include "work_mode.h"
+#include "test_common.h"
+
+#define US_PER_SEC              1000000LL
+#define STRESS_DEFAULT_MS       1000
+#define STRESS_DEFAULT_READERS  4
+#define STRESS_MAX_READERS      32
+#define STRESS_YIELD_EVERY      16          // Her 16 yazımda bir bölüm ortasında kesil
+#define LAT_SAMPLE_STRIDE       16          // Okumalarda her 16'da bir gecikme örneği
+#define LAT_SAMPLE_CAP          (1 << 18)
+#define COUNTER_THREADS         4
+#define COUNTER_OPS             200000      // İş parçacığı başına artış
+#define CYCLE_RESETS            2000
+#define CYCLE_EPOCH_SHIFT       20          // Sıfırlama j: başlangıç j << 20 (K*M bunun altında)
+
+_Static_assert((uint64_t)COUNTER_THREADS * COUNTER_OPS < (1U << CYCLE_EPOCH_SHIFT), "cycle epoch overflow");
+_Static_assert(((uint64_t)CYCLE_RESETS << CYCLE_EPOCH_SHIFT) < UINT32_MAX, "cycle epoch overflow");
+
+// Segment başlangıcı ile birikmiş süre aynı yazımdan gelirse değer sabittir:
+// (i s) + (PROBE - i s) = PROBE. Karışık kopya PROBE + (i - j) s verir.
+#define ACCT_PROBE_US           (1000000000LL * US_PER_SEC)   // Yazım no bunu geçmemeli
+
+// ============ Zaman Taklidi ============
+// Sadece yazar (time_accounting_set) okur: her yazım bir saniye kenarında
+static _Atomic int64_t s_now_us = 0;
+
+int64_t esp_timer_get_time(void) {
+    return atomic_load_explicit(&s_now_us, memory_order_relaxed);
+}
+
+// Duvar saati = esp_timer (ayar yok)
+int64_t time_service_second_start_us(int64_t at_us) {
+    return at_us - (at_us % US_PER_SEC);
+}
+
+// ============ Yazım Deseni ============
+static void pattern_fill(system_data_t *d, uint32_t i) {
+    d->target_count = i;
+    d->cycle_target_seconds = i * 3U + 1U;
+    d->current_epoch = ~i;
+    d->tick_edge_us = (int64_t)i * US_PER_SEC;
+    d->clock_hours = (uint8_t)i;
+    d->clock_minutes = (uint8_t)(i >> 8);
+    d->menu_step = (uint8_t)(i * 7U);
+}
+
+static bool pattern_data_ok(const system_data_t *d) {
+    system_data_t want = *d;
+    pattern_fill(&want, d->target_count);
+    return memcmp(&want, d, sizeof(want)) == 0;
+}
+
+static work_mode_t pattern_mode(uint32_t i) {
+    return (work_mode_t)(i % MODE_COUNT);
+}
+
+static shift_state_t pattern_shift(uint32_t i) {
+    return ((i >> 1) & 1U) ? SHIFT_STOPPED : SHIFT_RUNNING;
+}
+
+// ============ Gecikme İstatistiği ============
+typedef struct {
+    uint32_t *samples;
+    size_t n;
+    uint64_t count;
+    uint64_t total_ns;
+    uint32_t max_ns;
+} lat_stats_t;
+
+static void lat_init(lat_stats_t *s) {
+    memset(s, 0, sizeof(*s));
+    s->samples = malloc(LAT_SAMPLE_CAP * sizeof(uint32_t));
+}
+
+static void lat_add(lat_stats_t *s, uint64_t ns, uint32_t stride) {
+    uint32_t v = ns > UINT32_MAX ? UINT32_MAX : (uint32_t)ns;
+    if ((s->count % stride) == 0 && s->n < LAT_SAMPLE_CAP) {
+        s->samples[s->n++] = v;
+    }
+    s->count++;
+    s->total_ns += v;
+    if (v > s->max_ns) {
+        s->max_ns = v;
+    }
+}
+
+static void lat_merge(lat_stats_t *dst, const lat_stats_t *src) {
+    size_t room = LAT_SAMPLE_CAP - dst->n;
+    size_t take = src->n < room ? src->n : room;
+    memcpy(&dst->samples[dst->n], src->samples, take * sizeof(uint32_t));
+    dst->n += take;
+    dst->count += src->count;
+    dst->total_ns += src->total_ns;
+    if (src->max_ns > dst->max_ns) {
+        dst->max_ns = src->max_ns;
+    }
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void lat_print(const char *name, lat_stats_t *s) {
+    if (s->count == 0 || s->n == 0) {
+        printf("%-24s ölçüm yok\n", name);
+        return;
+    }
+    qsort(s->samples, s->n, sizeof(uint32_t), cmp_u32);
+    printf("%-24s %10llu işlem  ort %6.0f ns  p50 %6u ns  p99 %7u ns  max %8u ns\n", name,
+           (unsigned long long)s->count, (double)s->total_ns / (double)s->count,
+           s->samples[s->n / 2], s->samples[(s->n * 99) / 100], s->max_ns);
+}
+
+// ============ İş Parçacıkları ============
+static atomic_bool s_stop = false;
+static atomic_bool s_go = false;
+
+typedef struct {
+    lat_stats_t snap_lat;
+    lat_stats_t acct_lat;
+    uint64_t snap_torn;
+    uint64_t snap_backwards;
+    uint64_t acct_torn;
+    uint64_t raw_reads;
+    uint64_t raw_torn;
+    uint32_t first_bad_seq;
+} reader_result_t;
+
+static void *reader_thread(void *arg) {
+    reader_result_t *r = arg;
+    uint32_t last_seq = 0;
+    system_snapshot_t snap;
+
+    while (!atomic_load(&s_go)) {
+        sched_yield();
+    }
+    while (!atomic_load_explicit(&s_stop, memory_order_relaxed)) {
+        uint64_t t0 = test_now_ns();
+        sys_data_snapshot(&snap);
+        uint64_t t1 = test_now_ns();
+        lat_add(&r->snap_lat, t1 - t0, LAT_SAMPLE_STRIDE);
+
+        uint32_t i = snap.data.target_count;
+        bool ok = pattern_data_ok(&snap.data) && snap.mode == pattern_mode(i) &&
+                  snap.shift == pattern_shift(i) && snap.seq == 2U * i;
+        if (!ok) {
+            if (r->snap_torn++ == 0) {
+                r->first_bad_seq = snap.seq;
+            }
+        }
+        if (snap.seq < last_seq) {
+            r->snap_backwards++;
+        }
+        last_seq = snap.seq;
+
+        t0 = test_now_ns();
+        uint32_t v = time_accounting_get_at(ACCT_WORK, ACCT_PROBE_US);
+        t1 = test_now_ns();
+        lat_add(&r->acct_lat, t1 - t0, LAT_SAMPLE_STRIDE);
+        r->acct_torn += (v != (uint32_t)(ACCT_PROBE_US / US_PER_SEC));
+
+        // Kontrol: seqlock'suz düz kopya (testin yırtılma üretebildiğini gösterir)
+        system_data_t raw = *(const system_data_t *)&sys_data;
+        r->raw_reads++;
+        r->raw_torn += !pattern_data_ok(&raw);
+    }
+    return NULL;
+}
+
+typedef struct {
+    lat_stats_t write_lat;
+    uint32_t writes;
+} writer_result_t;
+
+static void *writer_thread(void *arg) {
+    writer_result_t *w = arg;
+    uint32_t i = 0;
+    system_data_t d;
+
+    while (!atomic_load(&s_go)) {
+        sched_yield();
+    }
+    while (!atomic_load_explicit(&s_stop, memory_order_relaxed)) {
+        i++;
+        pattern_fill(&d, i);
+        atomic_store_explicit(&s_now_us, (int64_t)i * US_PER_SEC, memory_order_relaxed);
+
+        uint64_t t0 = test_now_ns();
+        sys_data_write_begin();
+        sys_data.target_count = d.target_count;
+        sys_data.cycle_target_seconds = d.cycle_target_seconds;
+        current_mode = pattern_mode(i);
+        if ((i % STRESS_YIELD_EVERY) == 0) {
+            sched_yield();      // Yazar bölüm ortasında kesildi
+        }
+        sys_data.current_epoch = d.current_epoch;
+        sys_data.tick_edge_us = d.tick_edge_us;
+        if (i & 1U) {
+            sys_data_write_begin();     // İç içe bölüm (aynı task): yayın dıştaki end'de
+            sys_data.clock_hours = d.clock_hours;
+            sys_data_write_end();
+        } else {
+            sys_data.clock_hours = d.clock_hours;
+        }
+        time_accounting_set(ACCT_WORK, i);
+        sys_data.clock_minutes = d.clock_minutes;
+        shift_state = pattern_shift(i);
+        sys_data.menu_step = d.menu_step;
+        sys_data_write_end();
+        uint64_t t1 = test_now_ns();
+        // Kesilen yazımlar zamanlayıcı gecikmesini ölçer: istatistiğe katılmaz
+        if ((i % STRESS_YIELD_EVERY) != 0) {
+            lat_add(&w->write_lat, t1 - t0, 1);
+        }
+    }
+    w->writes = i;
+    return NULL;
+}
+
+static void test_seqlock(int duration_ms, int readers) {
+    // Başlangıç durumu (iş parçacıklarından önce): 0. yazım deseni, WORK sayacı çalışıyor
+    system_state_init();
+    pattern_fill((system_data_t *)&sys_data, 0);
+    current_mode = pattern_mode(0);
+    shift_state = pattern_shift(0);
+    {
+        // Sayaç maskesi WORK modunda açılır, sonra desen moduna dönülür (sync çağrılmaz)
+        current_mode = MODE_WORK;
+        sys_data.screen_on = true;
+        sys_data.counting_active = true;
+        time_accounting_sync();
+        time_accounting_set(ACCT_WORK, 0);
+        current_mode = pattern_mode(0);
+    }
+
+    pthread_t wt, rt[STRESS_MAX_READERS];
+    writer_result_t wres;
+    reader_result_t rres[STRESS_MAX_READERS];
+    memset(&wres, 0, sizeof(wres));
+    lat_init(&wres.write_lat);
+    for (int r = 0; r < readers; r++) {
+        memset(&rres[r], 0, sizeof(rres[r]));
+        lat_init(&rres[r].snap_lat);
+        lat_init(&rres[r].acct_lat);
+        pthread_create(&rt[r], NULL, reader_thread, &rres[r]);
+    }
+    pthread_create(&wt, NULL, writer_thread, &wres);
+
+    atomic_store(&s_go, true);
+    struct timespec ts = { duration_ms / 1000, (long)(duration_ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+    atomic_store(&s_stop, true);
+
+    pthread_join(wt, NULL);
+    lat_stats_t snap_all, acct_all;
+    lat_init(&snap_all);
+    lat_init(&acct_all);
+    uint64_t torn = 0, backwards = 0, acct_torn = 0, raw_reads = 0, raw_torn = 0;
+    for (int r = 0; r < readers; r++) {
+        pthread_join(rt[r], NULL);
+        lat_merge(&snap_all, &rres[r].snap_lat);
+        lat_merge(&acct_all, &rres[r].acct_lat);
+        torn += rres[r].snap_torn;
+        backwards += rres[r].snap_backwards;
+        acct_torn += rres[r].acct_torn;
+        raw_reads += rres[r].raw_reads;
+        raw_torn += rres[r].raw_torn;
+        if (rres[r].snap_torn) {
+            printf("okuyucu %d: ilk karışık kopya seq=%u\n", r, rres[r].first_bad_seq);
+        }
+    }
+
+    printf("Seqlock stres: 1 yazar, %d okuyucu, %d ms, %u yazım\n", readers, duration_ms, wres.writes);
+    lat_print("sys_data_snapshot", &snap_all);
+    lat_print("time_accounting_get_at", &acct_all);
+    lat_print("yazım bölümü", &wres.write_lat);
+    printf("korumasız kopya (kontrol): %llu / %llu yırtık\n",
+           (unsigned long long)raw_torn, (unsigned long long)raw_reads);
+
+    TEST_CHECK(wres.writes > 0, "yazar hiç yazmadı");
+    TEST_CHECK(snap_all.count > 0, "okuyucular hiç okumadı");
+    TEST_CHECK_EQ(torn, 0, "iki yazımı karıştıran snapshot");
+    TEST_CHECK_EQ(backwards, 0, "geri giden snapshot seq");
+    TEST_CHECK_EQ(acct_torn, 0, "segment/birikmiş karışık sayaç okuması");
+
+    // Son durum: tüm okuyucular durduktan sonra snapshot son yazımı göstermeli
+    system_snapshot_t last;
+    sys_data_snapshot(&last);
+    TEST_CHECK_EQ(last.data.target_count, wres.writes, "son snapshot yazım no");
+    TEST_CHECK_EQ(time_accounting_get_at(ACCT_WORK, (int64_t)wres.writes * US_PER_SEC), wres.writes,
+                  "son yazımdaki WORK sayacı (s)");
+}
+
+
+// ============ Gerçekleşen Adet ============
+typedef struct {
+    uint64_t backwards;
+    uint32_t last;
+    lat_stats_t lat;
+} produced_result_t;
+
+static void *produced_thread(void *arg) {
+    produced_result_t *r = arg;
+    while (!atomic_load(&s_go)) {
+        sched_yield();
+    }
+    for (int k = 0; k < COUNTER_OPS; k++) {
+        uint64_t t0 = test_now_ns();
+        uint32_t v = sys_produced_add(1);
+        lat_add(&r->lat, test_now_ns() - t0, LAT_SAMPLE_STRIDE);
+        r->backwards += (v <= r->last);     // Aynı değişkende RMW sonuçları artar
+        r->last = v;
+    }
+    return NULL;
+}
+
+static void test_produced_total(void) {
+    pthread_t th[COUNTER_THREADS];
+    produced_result_t res[COUNTER_THREADS];
+    lat_stats_t all;
+    uint64_t backwards = 0;
+    uint32_t max_seen = 0;
+
+    atomic_store(&s_go, false);
+    sys_produced_set(0);
+    lat_init(&all);
+    for (int t = 0; t < COUNTER_THREADS; t++) {
+        memset(&res[t], 0, sizeof(res[t]));
+        lat_init(&res[t].lat);
+        pthread_create(&th[t], NULL, produced_thread, &res[t]);
+    }
+    atomic_store(&s_go, true);
+    for (int t = 0; t < COUNTER_THREADS; t++) {
+        pthread_join(th[t], NULL);
+        lat_merge(&all, &res[t].lat);
+        backwards += res[t].backwards;
+        if (res[t].last > max_seen) {
+            max_seen = res[t].last;
+        }
+    }
+
+    printf("Adet: %d iş parçacığı x %d sys_produced_add(1)\n", COUNTER_THREADS, COUNTER_OPS);
+    lat_print("sys_produced_add", &all);
+    TEST_CHECK_EQ(sys_produced_get(), (uint64_t)COUNTER_THREADS * COUNTER_OPS, "adet toplamı");
+    TEST_CHECK_EQ(max_seen, (uint64_t)COUNTER_THREADS * COUNTER_OPS, "en büyük dönen adet");
+    TEST_CHECK_EQ(backwards, 0, "geri giden adet dönüşü");
+}
+
+// ============ Cycle Sayacı ============
+// LED task'ı gibi: çalışıyorsa ilerlet. Sıfırlayıcı j. sıfırlamada j << 20'den
+// başlatır; böylece her dönüş değeri hangi sıfırlamadan sonra geldiğini taşır.
+typedef struct {
+    uint64_t backwards;         // Aynı iş parçacığında dönüş artmadı
+    uint64_t overflow;          // Sıfırlama sonrası artış K*M'yi aştı
+    uint64_t last_epoch_adds;   // Son sıfırlamadan sonraki artışlar
+    uint32_t last;
+} cycle_result_t;
+
+static void *cycle_thread(void *arg) {
+    cycle_result_t *r = arg;
+    while (!atomic_load(&s_go)) {
+        sched_yield();
+    }
+    for (int done = 0; done < COUNTER_OPS; ) {
+        if (!cycle_counter_running()) {
+            sched_yield();
+            continue;
+        }
+        uint32_t v = cycle_counter_advance();
+        r->backwards += (v <= r->last);
+        r->overflow += (v & ((1U << CYCLE_EPOCH_SHIFT) - 1)) > (uint32_t)COUNTER_THREADS * COUNTER_OPS;
+        r->last_epoch_adds += (v >> CYCLE_EPOCH_SHIFT) == CYCLE_RESETS;
+        r->last = v;
+        done++;
+    }
+    return NULL;
+}
+
+static void *cycle_reset_thread(void *arg) {
+    while (!atomic_load(&s_go)) {
+        sched_yield();
+    }
+    for (uint32_t j = 1; j <= CYCLE_RESETS; j++) {
+        if (j & 1U) {
+            cycle_counter_stop();       // Ekran/mod değişimi: bar durur
+            sched_yield();
+        }
+        cycle_counter_start(j << CYCLE_EPOCH_SHIFT);
+        if (!cycle_counter_running() || cycle_counter_frames() < (j << CYCLE_EPOCH_SHIFT)) {
+            atomic_fetch_add((_Atomic uint32_t *)arg, 1);   // Sıfırlama kendi iş parçacığında görünmedi
+        }
+        sched_yield();
+    }
+    return NULL;
+}
+
+static void test_cycle_counter(void) {
+    pthread_t th[COUNTER_THREADS], rt;
+    cycle_result_t res[COUNTER_THREADS];
+    _Atomic uint32_t reset_lost = 0;
+
+    // Sıfırlama yok: tüm artışlar toplanır
+    atomic_store(&s_go, false);
+    cycle_counter_start(0);
+    for (int t = 0; t < COUNTER_THREADS; t++) {
+        memset(&res[t], 0, sizeof(res[t]));
+        pthread_create(&th[t], NULL, cycle_thread, &res[t]);
+    }
+    uint64_t t0 = test_now_ns();
+    atomic_store(&s_go, true);
+    uint64_t backwards = 0;
+    for (int t = 0; t < COUNTER_THREADS; t++) {
+        pthread_join(th[t], NULL);
+        backwards += res[t].backwards;
+    }
+    uint64_t ns = test_now_ns() - t0;
+    TEST_CHECK_EQ(cycle_counter_frames(), (uint64_t)COUNTER_THREADS * COUNTER_OPS, "cycle toplamı (sıfırlamasız)");
+    TEST_CHECK_EQ(backwards, 0, "geri giden cycle dönüşü (sıfırlamasız)");
+
+    // Eşzamanlı sıfırlama: son değer = son başlangıç + ondan sonraki artışlar
+    atomic_store(&s_go, false);
+    cycle_counter_start(0);
+    for (int t = 0; t < COUNTER_THREADS; t++) {
+        memset(&res[t], 0, sizeof(res[t]));
+        pthread_create(&th[t], NULL, cycle_thread, &res[t]);
+    }
+    pthread_create(&rt, NULL, cycle_reset_thread, (void *)&reset_lost);
+    atomic_store(&s_go, true);
+    pthread_join(rt, NULL);
+    uint64_t overflow = 0, last_epoch_adds = 0;
+    backwards = 0;
+    for (int t = 0; t < COUNTER_THREADS; t++) {
+        pthread_join(th[t], NULL);
+        backwards += res[t].backwards;
+        overflow += res[t].overflow;
+        last_epoch_adds += res[t].last_epoch_adds;
+    }
+
+    printf("Cycle: %d iş parçacığı x %d ilerletme, %d sıfırlama; sıfırlamasız %.1f ns/ilerletme\n",
+           COUNTER_THREADS, COUNTER_OPS, CYCLE_RESETS,
+           (double)ns / ((double)COUNTER_THREADS * COUNTER_OPS));
+    TEST_CHECK_EQ(backwards, 0, "geri giden cycle dönüşü (sıfırlamalı)");
+    TEST_CHECK_EQ(overflow, 0, "sıfırlama sonrası fazla artış");
+    TEST_CHECK_EQ(atomic_load(&reset_lost), 0, "sıfırlayıcının göremediği sıfırlama");
+    TEST_CHECK(cycle_counter_running(), "son sıfırlama cycle'ı çalıştırmalı");
+    TEST_CHECK_EQ(cycle_counter_frames(),
+                  ((uint64_t)CYCLE_RESETS << CYCLE_EPOCH_SHIFT) + last_epoch_adds,
+                  "son cycle değeri (başlangıç + sonraki artışlar)");
+}
+
+int main(int argc, char **argv) {
+    int duration_ms = argc > 1 ? atoi(argv[1]) : STRESS_DEFAULT_MS;
+    int readers = argc > 2 ? atoi(argv[2]) : STRESS_DEFAULT_READERS;
+    if (duration_ms <= 0) duration_ms = STRESS_DEFAULT_MS;
+    if (readers <= 0 || readers > STRESS_MAX_READERS) readers = STRESS_DEFAULT_READERS;
+
+    test_seqlock(duration_ms, readers);
+    test_produced_total();
+    test_cycle_counter();
+    TEST_DONE();
+}
@@ -0,0 +1,196 @@
+/*
+ * KlimasanAndonV2 - Çalışma modu kuralları testleri (host)
+ * Tablo tabanlı: tüm mod geçişlerinin aksiyonları, durum → çalışan sayaç
+ * maskesi ve adedin sadece aktif WORK'te sayılması.
+ */
+#include <stdio.h>
+
+#include "time_accounting.h"
+#include "work_mode.h"
+#include "test_common.h"
+
+#define W   (1U << ACCT_WORK)
+#define I   (1U << ACCT_IDLE)
+#define P   (1U << ACCT_PLANNED)
+#define D   (1U << ACCT_DURUS)
+
+static const char *const mode_names[MODE_COUNT] = { "STANDBY", "WORK", "IDLE", "PLANNED" };
+
+// ============ Mod Geçişleri ============
+typedef struct {
+    work_mode_t from;
+    work_mode_t to;
+    uint8_t act;
+} transition_case_t;
+
+#define TO_WORK     (MODE_ACT_DURUS_STOP | MODE_ACT_LED_CLEAR | MODE_ACT_PERSIST)
+#define NEW_DURUS   (MODE_ACT_DURUS_RESET | MODE_ACT_DURUS_START | MODE_ACT_PERSIST)
+#define KEEP_DURUS  (MODE_ACT_DURUS_START | MODE_ACT_PERSIST)
+
+static const transition_case_t transition_cases[] = {
+    // STANDBY'a hiçbir yerden buton/IR geçişi yok: aksiyon yok
+    { MODE_STANDBY, MODE_STANDBY, 0 },
+    { MODE_WORK,    MODE_STANDBY, 0 },
+    { MODE_IDLE,    MODE_STANDBY, 0 },
+    { MODE_PLANNED, MODE_STANDBY, 0 },
+    // WORK'e giriş duruşu dondurur ve LED barı temizler
+    { MODE_STANDBY, MODE_WORK,    TO_WORK },
+    { MODE_WORK,    MODE_WORK,    0 },
+    { MODE_IDLE,    MODE_WORK,    TO_WORK },
+    { MODE_PLANNED, MODE_WORK,    TO_WORK },
+    // WORK/STANDBY'dan duruşa geçiş yeni duruş başlatır
+    { MODE_STANDBY, MODE_IDLE,    NEW_DURUS },
+    { MODE_WORK,    MODE_IDLE,    NEW_DURUS },
+    { MODE_IDLE,    MODE_IDLE,    0 },
+    { MODE_PLANNED, MODE_IDLE,    KEEP_DURUS },
+    { MODE_STANDBY, MODE_PLANNED, NEW_DURUS },
+    { MODE_WORK,    MODE_PLANNED, NEW_DURUS },
+    { MODE_IDLE,    MODE_PLANNED, KEEP_DURUS },
+    { MODE_PLANNED, MODE_PLANNED, 0 },
+};
+
+static void test_transitions(void) {
+    size_t n = sizeof(transition_cases) / sizeof(transition_cases[0]);
+    TEST_CHECK_EQ(n, MODE_COUNT * MODE_COUNT, "geçiş tablosu satırı");
+    for (size_t i = 0; i < n; i++) {
+        const transition_case_t *c = &transition_cases[i];
+        uint8_t act = work_mode_transition(c->from, c->to);
+        TEST_CHECK(act == c->act, "%s → %s: 0x%02X, beklenen 0x%02X",
+                   mode_names[c->from], mode_names[c->to], act, c->act);
+    }
+
+    // Geçersiz mod (bozuk NVS) tabloyu taşırmaz
+    TEST_CHECK_EQ(work_mode_transition((work_mode_t)MODE_COUNT, MODE_WORK), 0, "geçersiz kaynak mod");
+    TEST_CHECK_EQ(work_mode_transition(MODE_WORK, (work_mode_t)7), 0, "geçersiz hedef mod");
+}
+
+// Tablo değişmezleri: durdurma ve başlatma aynı geçişte olmaz, aksiyonlu her geçiş kaydedilir
+static void test_transition_invariants(void) {
+    for (int from = 0; from < MODE_COUNT; from++) {
+        for (int to = 0; to < MODE_COUNT; to++) {
+            uint8_t act = work_mode_transition((work_mode_t)from, (work_mode_t)to);
+            TEST_CHECK(!((act & MODE_ACT_DURUS_STOP) && (act & MODE_ACT_DURUS_START)),
+                       "%s → %s duruşu hem durdurup hem başlatıyor", mode_names[from], mode_names[to]);
+            TEST_CHECK(act == 0 || (act & MODE_ACT_PERSIST),
+                       "%s → %s aksiyonlu ama kaydedilmiyor", mode_names[from], mode_names[to]);
+            TEST_CHECK(!(act & MODE_ACT_DURUS_RESET) || (act & MODE_ACT_DURUS_START),
+                       "%s → %s duruşu sıfırlayıp başlatmıyor", mode_names[from], mode_names[to]);
+        }
+    }
+}
+
+// Geçiş dizisi: duruş sayacının çalışıp çalışmadığını ve sıfırlandığını izle
+typedef struct {
+    work_mode_t seq[6];
+    size_t n;
+    bool durus_running;     // Dizinin sonunda
+    int durus_resets;       // Dizi boyunca kaç kez sıfırlandı
+} sequence_case_t;
+
+static const sequence_case_t sequence_cases[] = {
+    { { MODE_STANDBY, MODE_WORK }, 2, false, 0 },
+    { { MODE_STANDBY, MODE_IDLE }, 2, true, 1 },
+    { { MODE_WORK, MODE_IDLE, MODE_PLANNED }, 3, true, 1 },            // Duruş IDLE→PLANNED devam
+    { { MODE_WORK, MODE_IDLE, MODE_PLANNED, MODE_IDLE }, 4, true, 1 },
+    { { MODE_WORK, MODE_IDLE, MODE_WORK }, 3, false, 1 },
+    { { MODE_WORK, MODE_IDLE, MODE_WORK, MODE_PLANNED }, 4, true, 2 }, // Yeni duruş
+    { { MODE_IDLE, MODE_IDLE, MODE_IDLE }, 3, false, 0 },              // Aynı mod: tazele
+};
+
+static void test_sequences(void) {
+    for (size_t i = 0; i < sizeof(sequence_cases) / sizeof(sequence_cases[0]); i++) {
+        const sequence_case_t *c = &sequence_cases[i];
+        bool running = false;
+        int resets = 0;
+        for (size_t k = 1; k < c->n; k++) {
+            uint8_t act = work_mode_transition(c->seq[k - 1], c->seq[k]);
+            if (act & MODE_ACT_DURUS_STOP) running = false;
+            if (act & MODE_ACT_DURUS_RESET) resets++;
+            if (act & MODE_ACT_DURUS_START) running = true;
+        }
+        TEST_CHECK(running == c->durus_running, "dizi %zu: duruş çalışıyor=%d, beklenen %d",
+                   i, running, c->durus_running);
+        TEST_CHECK(resets == c->durus_resets, "dizi %zu: %d sıfırlama, beklenen %d",
+                   i, resets, c->durus_resets);
+    }
+}
+
+// ============ Sayma Kuralları ============
+typedef struct {
+    work_mode_state_t st;
+    uint32_t mask;
+    bool parts;
+} count_case_t;
+
+#define ST(mode, shift, screen, active, durus) { (mode), (shift), (screen), (active), (durus) }
+#define RUN     SHIFT_RUNNING
+#define STOP    SHIFT_STOPPED
+
+static const count_case_t count_cases[] = {
+    // Normal çalışma
+    { ST(MODE_WORK,    RUN, true, true, false), W,     true  },
+    { ST(MODE_WORK,    RUN, true, true, true),  W,     true  },   // durus_running WORK'te etkisiz
+    { ST(MODE_IDLE,    RUN, true, true, true),  I | D, false },
+    { ST(MODE_IDLE,    RUN, true, true, false), I,     false },
+    { ST(MODE_PLANNED, RUN, true, true, true),  P | D, false },
+    { ST(MODE_PLANNED, RUN, true, true, false), P,     false },
+    { ST(MODE_STANDBY, RUN, true, true, false), 0,     false },
+    { ST(MODE_STANDBY, RUN, true, true, true),  0,     false },
+    // WORK ama sayaç pasif: ekran kapalı, açılış sonrası buton bekleniyor, vardiya durdu
+    { ST(MODE_WORK,    RUN,  false, false, false), 0,  false },
+    { ST(MODE_WORK,    RUN,  false, true,  false), 0,  false },
+    { ST(MODE_WORK,    RUN,  true,  false, false), 0,  false },
+    { ST(MODE_WORK,    STOP, true,  true,  false), 0,  false },
+    { ST(MODE_IDLE,    STOP, true,  true,  true),  0,  false },
+    { ST(MODE_PLANNED, RUN,  false, true,  true),  0,  false },
+};
+
+static void test_counting(void) {
+    for (size_t i = 0; i < sizeof(count_cases) / sizeof(count_cases[0]); i++) {
+        const count_case_t *c = &count_cases[i];
+        uint32_t mask = work_mode_counter_mask(&c->st);
+        bool parts = work_mode_counts_parts(&c->st);
+        TEST_CHECK(mask == c->mask, "durum %zu (%s): maske 0x%X, beklenen 0x%X",
+                   i, mode_names[c->st.mode], mask, c->mask);
+        TEST_CHECK(parts == c->parts, "durum %zu (%s): adet=%d, beklenen %d",
+                   i, mode_names[c->st.mode], parts, c->parts);
+    }
+}
+
+// Tüm durum uzayı: adet yalnız WORK sayacı çalışırken, en fazla bir zaman modu sayar
+static void test_counting_exhaustive(void) {
+    int parts_states = 0;
+    for (int mode = 0; mode < MODE_COUNT; mode++) {
+        for (int bits = 0; bits < 16; bits++) {
+            work_mode_state_t st = {
+                .mode = (work_mode_t)mode,
+                .shift = (bits & 1) ? SHIFT_STOPPED : SHIFT_RUNNING,
+                .screen_on = (bits & 2) != 0,
+                .counting_active = (bits & 4) != 0,
+                .durus_running = (bits & 8) != 0,
+            };
+            uint32_t mask = work_mode_counter_mask(&st);
+            uint32_t time_bits = mask & (W | I | P);
+            bool parts = work_mode_counts_parts(&st);
+
+            TEST_CHECK((time_bits & (time_bits - 1)) == 0, "%s/0x%X: birden fazla zaman sayacı 0x%X",
+                       mode_names[mode], bits, mask);
+            TEST_CHECK(!(mask & D) || (time_bits & (I | P)), "%s/0x%X: duruş tek başına sayıyor",
+                       mode_names[mode], bits);
+            TEST_CHECK(parts == ((mask & W) != 0), "%s/0x%X: adet kararı WORK sayacından farklı",
+                       mode_names[mode], bits);
+            parts_states += parts;
+        }
+    }
+    // WORK + vardiya sürüyor + ekran açık + sayaç aktif (duruş bayrağı serbest)
+    TEST_CHECK_EQ(parts_states, 2, "adet sayan durum");
+}
+
+int main(void) {
+    test_transitions();
+    test_transition_invariants();
+    test_sequences();
+    test_counting();
+    test_counting_exhaustive();
+    TEST_DONE();
+}